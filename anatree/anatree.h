@@ -25,574 +25,5711 @@
 // 'std::sort(...)'
 #include<algorithm>
 
-// 'std::unique_ptr' and 'std::stringstream' for 'anatree<>::node'
-#include<memory>
+// 'uint32_t', 'std::numeric_limits', and 'std::stringstream' for
+// 'anatree<>::node'
+#include<cstdint>
+#include<limits>
 #include<sstream>
 
 // 'std::string', 'std::unordered_set', and 'std::unordered_map' for
 // 'anatree<...>' template parameters
 #include<string>
+#include<string_view>
 #include<unordered_set>
 #include<unordered_map>
 
+// 'std::vector' for the node arena
+#include<vector>
+
+// 'std::array' and 'std::tuple' for 'frequency_order<...>' and
+// 'anatree<...>::tree_size_of(...)'
+#include<array>
+#include<tuple>
+
+// 'std::bit_width' and 'std::index_sequence' for 'alphabet<...>'
+#include<bit>
+#include<utility>
+
+// 'std::reference_wrapper' for results of batched queries
+#include<functional>
+
+// 'std::shared_ptr', 'std::span', 'std::memcpy', file streams, and exceptions
+// for the binary format of 'frozen_anatree<...>'
+#include<cstddef>
+#include<cstring>
+#include<fstream>
+#include<memory>
+#include<span>
+#include<stdexcept>
+
+// 'std::ranges::iota_view' for the word identifiers of 'frozen_anatree<...>'
+#include<ranges>
+
+// 'std::async', 'std::atomic', 'std::mutex', and 'std::thread' for parallel
+// queries and 'concurrent_anatree<...>'
+#include<atomic>
+#include<future>
+#include<mutex>
+#include<thread>
+
+// POSIX memory-mapping for 'frozen_anatree<...>::load_mmap(...)'
+#if __has_include(<sys/mman.h>)
+#define ANATREE_HAS_MMAP
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<unistd.h>
+#endif
+
 // C++20 concepts
 #include <concepts>
 #include <iterator>
+#include <type_traits>
 
 ////////////////////////////////////////////////////////////////////////////////
-/// \brief A data structure capable of storing a set of 'std::string' (or
-///        similar) data structures, enabling quick access to all 'anagrams' of
-///        each word (within or not).
-///
-/// \tparam T       Type for words, i.e. lists of elemnts. This type should
-///                 provide the interface of `std::string`, such as
-///                 `std::basic_string<_>` and `std::vector<_>`.
-///
-/// \tparam Compare Ordering of the symbols within each word. The order has a
-///                 major impact on the size.
-///
-/// \tparam Set     Type to be used for storing and returning sets of words.
-///
-/// \tparam Map     Type to be used for storing pairs `T`.
+/// \brief Internal helpers that are shared by `anatree<...>` and
+///        `frozen_anatree<...>`.
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T       = std::string,
-         typename Compare = std::less<typename T::value_type>,
-         typename Set     = std::unordered_set<T>,
-         typename Map     = std::unordered_map<T, T>>
-requires std::copyable<T>
-      && std::sortable<typename T::iterator, Compare>
-      && std::equality_comparable<typename T::value_type>
-      && std::totally_ordered<typename T::value_type>
-class anatree
+namespace anatree_internal
 {
-private:
   //////////////////////////////////////////////////////////////////////////////
-  /// \brief Type of each individual character.
+  /// \brief Whether characters of type `C` compared with `Compare` can be
+  ///        sorted with a counting sort over all of their values.
   //////////////////////////////////////////////////////////////////////////////
-  using value_type = typename T::value_type;
+  template<typename C, typename Compare>
+  constexpr bool counting_sortable =
+    sizeof(C) == 1u && std::is_integral_v<C> && !std::is_same_v<C, bool>
+    && (std::is_same_v<Compare, std::less<C>> || std::is_same_v<Compare, std::less<>>
+        || std::is_same_v<Compare, std::greater<C>> || std::is_same_v<Compare, std::greater<>>);
 
-private:
   //////////////////////////////////////////////////////////////////////////////
-  /// \brief Individual node of the Anatree.
+  /// \brief Whether `Compare` orders a fixed set of characters by mapping each
+  ///        of them to a dense index, e.g. `alphabet<...>`.
   //////////////////////////////////////////////////////////////////////////////
-  class node
+  template<typename Compare, typename C>
+  concept dense_alphabet = requires (const C c) {
+    { Compare::size } -> std::convertible_to<size_t>;
+    { Compare::index_of(c) } -> std::convertible_to<size_t>;
+    { Compare::letters[0] } -> std::convertible_to<C>;
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief The character used to mark NIL nodes, i.e. one that (presumably)
+  ///        is not part of any word.
+  ///
+  /// \details If `Compare` provides one (e.g. `alphabet<...>`), then it is
+  ///          guaranteed to be outside of the alphabet. Otherwise, it is 0.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename C, typename Compare>
+  constexpr C
+  nil_char()
+  {
+    if constexpr (requires { { Compare::nil } -> std::convertible_to<C>; }) {
+      return Compare::nil;
+    } else {
+      return C(0);
+    }
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Words up to this length are sorted with `std::sort` (i.e. with an
+  ///        insertion sort) even if a counting sort is possible.
+  //////////////////////////////////////////////////////////////////////////////
+  constexpr size_t counting_sort_threshold = 32u;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Sort the characters in [first, last) in-place.
+  ///
+  /// \details For byte-sized characters in (reverse) natural order and for
+  ///          dense alphabets, this uses a counting sort without any
+  ///          allocation.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename RandomIt, typename Compare>
+  void
+  sort_chars(RandomIt first, RandomIt last, const Compare &comp)
+  {
+    using C = std::iter_value_t<RandomIt>;
+
+    if constexpr (dense_alphabet<Compare, C>) {
+      if (static_cast<size_t>(last - first) > std::min(counting_sort_threshold, Compare::size)) {
+        // One bucket per letter and one for all other characters.
+        size_t counts[Compare::size + 1u] = { };
+        for (RandomIt it = first; it != last; ++it) {
+          counts[Compare::index_of(*it)]++;
+        }
+
+        // Case: Only letters of the alphabet
+        // -> Place them from their buckets.
+        if (counts[Compare::size] == 0u) {
+          for (size_t b = 0u; b < Compare::size; ++b) {
+            first = std::fill_n(first, counts[b], Compare::letters[b]);
+          }
+          return;
+        }
+      }
+    }
+
+    if constexpr (counting_sortable<C, Compare>) {
+      if (static_cast<size_t>(last - first) > counting_sort_threshold) {
+        using U = std::make_unsigned_t<C>;
+
+        // Shift signed values, such that the order of the buckets matches the
+        // order of the characters.
+        constexpr U shift = std::is_signed_v<C> ? 0x80u : 0x00u;
+
+        size_t counts[256] = { };
+        for (RandomIt it = first; it != last; ++it) {
+          counts[static_cast<U>(static_cast<U>(*it) ^ shift)]++;
+        }
+
+        constexpr bool ascending = std::is_same_v<Compare, std::less<C>>
+                                || std::is_same_v<Compare, std::less<>>;
+
+        for (size_t b = 0u; b < 256u; ++b) {
+          const size_t bucket = ascending ? b : 255u - b;
+          const C c = static_cast<C>(static_cast<U>(bucket) ^ shift);
+          first = std::fill_n(first, counts[bucket], c);
+        }
+        return;
+      }
+    }
+    // Pass the comparator by reference, since it may carry (shared) state.
+    std::sort(first, last, std::cref(comp));
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Add the words of `from` to `to`.
+  ///
+  /// \details If `Set` provides `merge` (e.g. `std::set` and
+  ///          `std::unordered_set`), its nodes are spliced over and `from` is
+  ///          left with the words `to` already had. Otherwise, all words are
+  ///          inserted into `to` one by one.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename Set>
+  void
+  merge_words(Set &to, Set &from)
+  {
+    if constexpr (requires { to.merge(from); }) {
+      to.merge(from);
+    } else {
+      for (const auto &w : from) { to.insert(w); }
+    }
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Sorted copy of the characters of a word, i.e. its key.
+  ///
+  /// \details Keys of up to `inline_size` characters are stored within the
+  ///          object itself (i.e. usually on the stack) to avoid allocating
+  ///          memory on the heap for each query.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename C>
+  class key_buffer
   {
   public:
-    using ptr = std::unique_ptr<node>;
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Number of characters stored without any heap allocation.
+    ////////////////////////////////////////////////////////////////////////////
+    static constexpr size_t inline_size = std::max<size_t>(256u / sizeof(C), 1u);
 
-    // TODO: derive a non-useful value as 'NIL'.
-    static constexpr value_type NIL = 0;
+  private:
+    C m_inline[inline_size];
+    std::unique_ptr<C[]> m_heap;
+    C* m_begin;
+    C* m_end;
 
   public:
     ////////////////////////////////////////////////////////////////////////////
-    /// \brief Character in this node
+    /// \brief Create the key of the word [first, last) with its characters
+    ///        sorted by `comp`.
     ////////////////////////////////////////////////////////////////////////////
-    value_type m_char = NIL;
+    template<typename InputIt, typename Compare>
+    key_buffer(InputIt first, InputIt last, const Compare &comp)
+      : key_buffer(first, last, comp, [](const C&) { return true; })
+    { }
 
     ////////////////////////////////////////////////////////////////////////////
-    /// \brief Binary choice on children.
-    ///
-    /// Follow the 'false' pointer, if 'm_char' does not occur in the word.
-    /// Otherwise follow the 'true' pointer, if it does.
+    /// \brief Create the key of the word [first, last) with its characters
+    ///        sorted by `comp`, but only including the ones satisfying `pred`.
+    ////////////////////////////////////////////////////////////////////////////
+    template<typename InputIt, typename Compare, typename Pred>
+    key_buffer(InputIt first, InputIt last, const Compare &comp, const Pred &pred)
+    {
+      const size_t size = std::distance(first, last);
+      if (size <= inline_size) {
+        m_begin = m_inline;
+      } else {
+        m_heap  = std::make_unique<C[]>(size);
+        m_begin = m_heap.get();
+      }
+      m_end = std::copy_if(first, last, m_begin, pred);
+      sort_chars(m_begin, m_end, comp);
+    }
+
+    key_buffer(const key_buffer&) = delete;
+    key_buffer(key_buffer&&) = delete;
+
+  public:
+    const C* begin() const { return m_begin; }
+    const C* end() const   { return m_end; }
+
+    size_t size() const { return m_end - m_begin; }
+
+    const C& operator[](const size_t i) const { return m_begin[i]; }
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Last owner handed out to any `cow_array<...>`.
+  //////////////////////////////////////////////////////////////////////////////
+  inline std::atomic<uint64_t> last_page_owner = 0u;
+
+  inline uint64_t
+  next_page_owner()
+  {
+    return last_page_owner.fetch_add(1u, std::memory_order_relaxed) + 1u;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Array of elements, split into fixed-size pages that are shared
+  ///        (copy-on-write) between copies of the array.
+  ///
+  /// \details Copying the array only copies the pointers to its pages, i.e. it
+  ///          takes O(N / page_size) time and memory. Mutable access to an
+  ///          element copies its entire page first, unless the page has been
+  ///          created by this array since it was last copied. Hence, an update
+  ///          that touches only a few elements only copies a few pages. Since
+  ///          pages are never moved, adding elements does not invalidate
+  ///          references to other elements.
+  ///
+  ///          Whether a page may be changed in-place is decided by the owner
+  ///          recorded in it rather than by its reference count, since another
+  ///          thread may still (or just have stopped to) read it. Copying an
+  ///          array gives both the copy and the original a new owner, so
+  ///          neither of them changes any page it shares with the other.
+  ///
+  ///          Reading an element with `operator[]` never copies anything. To
+  ///          change it, it has to be accessed with `mut(i)` instead.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename X>
+  class cow_array
+  {
+  public:
     ////////////////////////////////////////////////////////////////////////////
-    ptr m_children[2] = { nullptr, nullptr };
+    /// \brief Number of elements within each page.
+    ////////////////////////////////////////////////////////////////////////////
+    static constexpr size_t page_size = 64u;
+
+  private:
+    struct page
+    {
+      std::array<X, page_size> elems;
+
+      //////////////////////////////////////////////////////////////////////////
+      /// \brief The only array that may change this page in-place (set once,
+      ///        before the page is shared).
+      //////////////////////////////////////////////////////////////////////////
+      uint64_t owner;
+    };
+
+    std::vector<std::shared_ptr<page>> m_pages;
+    size_t m_size = 0u;
 
     ////////////////////////////////////////////////////////////////////////////
-    /// \brief Set of words that are anagrams of the path up to this node.
+    /// \brief Owner of the pages created by this array, which is replaced
+    ///        whenever the array is copied (also when it is the source).
     ////////////////////////////////////////////////////////////////////////////
-    Set m_words;
+    mutable std::atomic<uint64_t> m_owner = next_page_owner();
 
   public:
     ////////////////////////////////////////////////////////////////////////////
-    /// \brief Initialize a NIL node
+    /// \brief Array with `n` default-constructed elements.
     ////////////////////////////////////////////////////////////////////////////
-    void init(value_type c, ptr f_ptr = nullptr, ptr t_ptr = nullptr)
+    explicit cow_array(const size_t n = 0u)
+    {
+      while (m_size < n) { emplace_back(); }
+    }
+
+    cow_array(const cow_array &o)
+      : m_pages(o.m_pages), m_size(o.m_size)
+    {
+      o.m_owner.store(next_page_owner(), std::memory_order_relaxed);
+    }
+
+    cow_array(cow_array &&o) noexcept
+      : m_pages(std::move(o.m_pages)), m_size(o.m_size),
+        m_owner(o.m_owner.load(std::memory_order_relaxed))
+    {
+      o.m_pages.clear();
+      o.m_size = 0u;
+      o.m_owner.store(next_page_owner(), std::memory_order_relaxed);
+    }
+
+    cow_array& operator=(const cow_array &o)
     {
-      assert(m_char == NIL && c != NIL);
-      m_char = c;
-      m_children[false] = f_ptr ? std::move(f_ptr) : make_node();
-      m_children[true]  = t_ptr ? std::move(t_ptr) : make_node();
+      if (this != &o) {
+        m_pages = o.m_pages;
+        m_size  = o.m_size;
+        m_owner.store(next_page_owner(), std::memory_order_relaxed);
+        o.m_owner.store(next_page_owner(), std::memory_order_relaxed);
+      }
+      return *this;
+    }
+
+    cow_array& operator=(cow_array &&o) noexcept
+    {
+      if (this != &o) {
+        m_pages = std::move(o.m_pages);
+        m_size  = o.m_size;
+        m_owner.store(o.m_owner.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        o.m_pages.clear();
+        o.m_size = 0u;
+        o.m_owner.store(next_page_owner(), std::memory_order_relaxed);
+      }
+      return *this;
     }
 
   public:
+    size_t size() const { return m_size; }
+    bool empty() const  { return m_size == 0u; }
+
     ////////////////////////////////////////////////////////////////////////////
-    /// \brief Empty (NIL) constructor
+    /// \brief Number of elements that fit into the allocated pages.
     ////////////////////////////////////////////////////////////////////////////
-    node() = default;
+    size_t capacity() const { return m_pages.size() * page_size; }
 
     ////////////////////////////////////////////////////////////////////////////
-    /// \brief Empty (NIL) ptr constructor
+    /// \brief Number of pages that are (also) used by another array.
+    ///
+    /// \details This is only a snapshot for statistics, since other arrays
+    ///          may be released concurrently.
     ////////////////////////////////////////////////////////////////////////////
-    static ptr make_node()
-    { return std::make_unique<node>(); }
+    size_t shared_pages() const
+    {
+      return std::count_if(m_pages.begin(), m_pages.end(), [](const std::shared_ptr<page> &pg) {
+        return pg.use_count() > 1;
+      });
+    }
+
+  public:
+    const X& operator[](const size_t i) const
+    {
+      return m_pages[i / page_size]->elems[i % page_size];
+    }
 
     ////////////////////////////////////////////////////////////////////////////
-    /// \brief Copy constructor
+    /// \brief Whether the page of the `i`th element is owned by this array,
+    ///        i.e. `mut(i)` does not copy it.
     ////////////////////////////////////////////////////////////////////////////
-    node(const node&) = default;
+    bool owns(const size_t i) const
+    {
+      return m_pages[i / page_size]->owner == m_owner.load(std::memory_order_relaxed);
+    }
 
     ////////////////////////////////////////////////////////////////////////////
-    /// \brief Non-nil ptr constructor
+    /// \brief Mutable access to the `i`th element, copying its page first if
+    ///        it is not owned by this array.
     ////////////////////////////////////////////////////////////////////////////
-    node(const value_type c, ptr f_ptr = make_node(), ptr t_ptr = make_node())
-    { init(c, std::move(f_ptr), std::move(t_ptr)); };
+    X& mut(const size_t i)
+    {
+      const uint64_t owner = m_owner.load(std::memory_order_relaxed);
 
+      std::shared_ptr<page> &pg = m_pages[i / page_size];
+      if (pg->owner != owner) { pg = std::make_shared<page>(page{ pg->elems, owner }); }
+      return pg->elems[i % page_size];
+    }
+
+  public:
     ////////////////////////////////////////////////////////////////////////////
-    /// \brief Non-nil constructor
+    /// \brief Add a default-constructed element at the end.
     ////////////////////////////////////////////////////////////////////////////
-    static ptr make_node(value_type c, ptr f_ptr = make_node(), ptr t_ptr = make_node())
-    { return std::make_unique<node>(c, std::move(f_ptr), std::move(t_ptr)); }
+    X& emplace_back()
+    {
+      if (m_size == capacity()) {
+        m_pages.push_back(std::make_shared<page>(page{ {}, m_owner.load(std::memory_order_relaxed) }));
+      }
+      return mut(m_size++);
+    }
 
-  public:
     ////////////////////////////////////////////////////////////////////////////
-    std::string to_string()
+    /// \brief Add `x` at the end.
+    ////////////////////////////////////////////////////////////////////////////
+    void push_back(X x)
     {
-      std::stringstream ss;
-      ss << "{ char: " << m_char
-         << ", children: { " << m_children[false] << ", " << m_children[true]
-         << " } }";
-      return ss.str();
+      emplace_back() = std::move(x);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Reserve space for the pages of `n` elements.
+    ////////////////////////////////////////////////////////////////////////////
+    void reserve(const size_t n)
+    {
+      m_pages.reserve((n + page_size - 1u) / page_size);
     }
   };
 
-private:
   //////////////////////////////////////////////////////////////////////////////
-  /// \brief Alias for 'node::ptr' that allows omitting the 'typename' keyword.
+  /// \brief Last epoch handed out to any Anatree (see `anatree<...>::epoch()`).
   //////////////////////////////////////////////////////////////////////////////
-  using node_ptr = typename node::ptr;
+  inline std::atomic<uint64_t> last_epoch = 0u;
 
-private:
   //////////////////////////////////////////////////////////////////////////////
-  /// \brief Comparator for characters.
+  /// \brief A new epoch, distinct from all previous ones within this process.
   //////////////////////////////////////////////////////////////////////////////
-  Compare m_char_comp = Compare();
+  inline uint64_t
+  next_epoch()
+  {
+    return last_epoch.fetch_add(1u, std::memory_order_relaxed) + 1u;
+  }
+}
 
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Counters for the work done by queries on an `anatree<...>`.
+///
+/// \details These are only counted if `ANATREE_STATS` is defined before this
+///          header is included. Otherwise, they are always zero and counting
+///          has no overhead.
+///
+/// \see anatree<...>::query_stats()
+////////////////////////////////////////////////////////////////////////////////
+struct traversal_stats
+{
   //////////////////////////////////////////////////////////////////////////////
-  /// \brief Root of the anatree (initially a NIL node).
+  /// \brief Number of nodes visited.
   //////////////////////////////////////////////////////////////////////////////
-  node_ptr m_root = node::make_node();
+  uint64_t nodes_visited = 0u;
 
   //////////////////////////////////////////////////////////////////////////////
-  /// \brief Number of words stored within this tree.
+  /// \brief Number of 'false' edges followed.
   //////////////////////////////////////////////////////////////////////////////
-  size_t m_size = 0u;
+  uint64_t false_edges = 0u;
 
   //////////////////////////////////////////////////////////////////////////////
-  /// \brief Number of nodes (including NIL) in the tree.
+  /// \brief Number of 'true' edges followed.
   //////////////////////////////////////////////////////////////////////////////
-  size_t m_tree_size = 1u;
+  uint64_t true_edges = 0u;
 
   //////////////////////////////////////////////////////////////////////////////
-  /// \brief Unique `null` pointer to have a *no* return value.
+  /// \brief Number of words copied into a returned `Set`.
   //////////////////////////////////////////////////////////////////////////////
-  const node_ptr m_null = nullptr;
+  uint64_t words_copied = 0u;
 
-public:
   //////////////////////////////////////////////////////////////////////////////
-  /// \brief Constructor of an empty Anatree.
+  /// \brief Number of words whose characters have been sorted.
   //////////////////////////////////////////////////////////////////////////////
-  constexpr
-  anatree(Compare char_comp = Compare())
-    : m_char_comp(char_comp)
-  { }
+  uint64_t sorted_keys = 0u;
 
-public:
   //////////////////////////////////////////////////////////////////////////////
-  /// \brief Copy-constructor, creating a deep copy of another Anatree.
-  ///
-  /// \warning Requires \f$O(N)\f$ time.
+  /// \brief Number of queries answered by a `query_cache<...>`.
   //////////////////////////////////////////////////////////////////////////////
-  constexpr
-  anatree(const anatree &a)
-    : m_char_comp(a.m_char_comp)
-    , m_root(deep_copy(a.m_root))
-    , m_size(a.m_size)
-    , m_tree_size(a.m_tree_size)
-  { }
+  uint64_t cache_hits = 0u;
 
-private:
-  static
-  node_ptr
-  deep_copy(const node_ptr &p)
-  {
-    node_ptr np = node::make_node();
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of queries a `query_cache<...>` had to pass on to the
+  ///        Anatree (since the key was missing or its result was outdated).
+  //////////////////////////////////////////////////////////////////////////////
+  uint64_t cache_misses = 0u;
+};
 
-    // Case: NIL
-    // -> Leave node as-is
-    if (p->m_char == node::NIL) {
-      assert(p->m_children[false] == nullptr && p->m_children[true] == nullptr);
-    }
+namespace anatree_internal
+{
+#ifdef ANATREE_STATS
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Counters of all queries on the current thread.
+  //////////////////////////////////////////////////////////////////////////////
+  inline thread_local traversal_stats thread_stats;
 
-    // Case: not NIL
-    // -> Obtain recursively deep copy of children and copy over 'm_char'
-    else {
-      np->m_char = p->m_char;
-      np->m_children[false] = deep_copy(p->m_children[false]);
-      np->m_children[true]  = deep_copy(p->m_children[true]);
-    }
+#define ANATREE_COUNT(counter, n) (anatree_internal::thread_stats.counter += (n))
+#else
+#define ANATREE_COUNT(counter, n) ((void) 0)
+#endif
+}
 
-    // Copy over the set of words stored within this node.
-    np->m_words = p->m_words;
-    return std::move(np);
-  }
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Memory used by an `anatree<...>`, see `anatree<...>::memory_usage()`.
+////////////////////////////////////////////////////////////////////////////////
+struct memory_stats
+{
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Bytes reserved for the node arena (including free entries).
+  //////////////////////////////////////////////////////////////////////////////
+  size_t node_bytes = 0u;
 
-public:
   //////////////////////////////////////////////////////////////////////////////
-  /// \brief Move-constructor, taking over ownership of the other's tree.
+  /// \brief (Estimated) bytes of all sets of words, including the words
+  ///        themselves.
   //////////////////////////////////////////////////////////////////////////////
-  constexpr
-  anatree(anatree&&) = default;
+  size_t set_bytes = 0u;
 
-public:
   //////////////////////////////////////////////////////////////////////////////
-  /// \brief Contruct a tree containing all of the given words.
+  /// \brief Number of concrete nodes with a character.
   //////////////////////////////////////////////////////////////////////////////
-  template <typename InputIt>
-  requires std::input_iterator<InputIt>
-        && std::is_convertible<typename InputIt::value_type, T>::value
-  constexpr
-  anatree(InputIt first, InputIt last)
-    : anatree()
-  {
-    insert(first, last);
-  }
+  size_t internal_nodes = 0u;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of concrete NIL leaves (i.e. excluding the shared one).
+  //////////////////////////////////////////////////////////////////////////////
+  size_t nil_nodes = 0u;
 
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of released nodes waiting to be reused.
+  //////////////////////////////////////////////////////////////////////////////
+  size_t free_nodes = 0u;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of (non-empty) sets of words.
+  //////////////////////////////////////////////////////////////////////////////
+  size_t word_sets = 0u;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of pages of nodes and of sets of words that are shared with
+  ///        a copy of the tree, i.e. that are not (yet) duplicated.
+  //////////////////////////////////////////////////////////////////////////////
+  size_t shared_pages = 0u;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Ordering of characters derived from how often they occur in a corpus
+///        of words, e.g. to be used as the `Compare` of `anatree<...>`.
+///
+/// \details The ordering is stored (and shared between copies) within the
+///          comparator. Hence, it is applied consistently, when the Anatree
+///          sorts the characters of a word and when it traverses the tree.
+///          Characters that do not occur in the corpus are placed after all
+///          others. Ties are broken by the natural order of the characters.
+///
+/// \see anatree<...>::tree_size_of
+///
+/// \tparam C Type of characters.
+////////////////////////////////////////////////////////////////////////////////
+template<typename C>
+class frequency_order
+{
 public:
   //////////////////////////////////////////////////////////////////////////////
-  /// \brief Adds the word 'w' to the anatree.
+  /// \brief How to derive the ordering from the number of words in the corpus
+  ///        that include each character.
   //////////////////////////////////////////////////////////////////////////////
-  void
-  insert(const T &w)
+  enum class strategy
   {
-    T key = sorted_word(w);
-    m_root = insert__rec(std::move(m_root), w, key.begin(), key.end());
-  }
+    /** Same as `std::less<C>`. */
+    natural,
+    /** Characters that are in the fewest words first. */
+    rarest_first,
+    /** Characters that are in the most words first. */
+    most_frequent_first,
+    /** Characters that split the words most evenly first. */
+    most_discriminating_first,
+  };
 
-private:
-  node_ptr
-  insert__rec(node_ptr &&p,
-              const T &w,
-              typename T::iterator curr,
-              const typename T::iterator end)
-  {
-    assert(p != nullptr);
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief All strategies, e.g. to find the best one for some corpus.
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr strategy strategies[] = {
+    strategy::natural,
+    strategy::rarest_first,
+    strategy::most_frequent_first,
+    strategy::most_discriminating_first,
+  };
 
-    // Case: Iterator done
-    // -> Insert word
-    if (curr == end) {
-      if (!p->m_words.contains(w)) {
-        m_size++;
-        p->m_words.insert(w);
-      }
-      return p;
-    }
+private:
+  using rank_type = uint32_t;
 
-    // Case: NIL
-    // -> Turn into non-NIL node
-    if (p->m_char == node::NIL) {
-      assert(p->m_children[false] == nullptr && p->m_children[true] == nullptr);
-      p->init(*curr);
-      m_tree_size += 2; // <- NIL 'false' and 'true' children
-      p->m_children[true] = insert__rec(std::move(p->m_children[true]), w, ++curr, end);
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Rank of characters that do not occur in the corpus.
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr rank_type unranked = std::numeric_limits<rank_type>::max();
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Rank of each character. For byte-sized characters, this is a
+  ///        direct lookup table.
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr bool direct_table = sizeof(C) == 1u;
+
+  using table_type = std::conditional_t<direct_table,
+                                        std::array<rank_type, 256>,
+                                        std::unordered_map<C, rank_type>>;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Shared table of ranks (nullptr for the natural order).
+  //////////////////////////////////////////////////////////////////////////////
+  std::shared_ptr<const table_type> m_ranks;
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Natural order of the characters, i.e. `std::less<C>`.
+  //////////////////////////////////////////////////////////////////////////////
+  frequency_order() = default;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Ordering derived from the words in [first, last).
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename InputIt>
+  requires std::input_iterator<InputIt>
+  frequency_order(InputIt first, InputIt last, const strategy s = strategy::rarest_first)
+  {
+    if (s == strategy::natural) { return; }
+
+    // Count the number of words that include each character.
+    std::unordered_map<C, size_t> counts;
+    size_t words = 0u;
+
+    std::vector<C> seen;
+    for (; first != last; ++first, ++words) {
+      seen.assign(first->begin(), first->end());
+      std::sort(seen.begin(), seen.end());
+      seen.erase(std::unique(seen.begin(), seen.end()), seen.end());
+
+      for (const C c : seen) { counts[c]++; }
+    }
+
+    // Sort characters by their score (and resolve ties by their value).
+    std::vector<std::pair<size_t, C>> scores;
+    scores.reserve(counts.size());
+    for (const auto &[c, count] : counts) {
+      switch (s) {
+      case strategy::rarest_first:
+        scores.push_back({ count, c });
+        break;
+      case strategy::most_frequent_first:
+        scores.push_back({ words - count, c });
+        break;
+      case strategy::most_discriminating_first:
+        scores.push_back({ 2u*count < words ? words - 2u*count : 2u*count - words, c });
+        break;
+      case strategy::natural:
+        break;
+      }
+    }
+    std::sort(scores.begin(), scores.end());
+
+    auto ranks = std::make_shared<table_type>();
+    if constexpr (direct_table) { ranks->fill(unranked); }
+    for (rank_type r = 0u; r < scores.size(); ++r) {
+      (*ranks)[index(scores[r].second)] = r;
+    }
+    m_ranks = std::move(ranks);
+  }
+
+private:
+  static auto
+  index(const C c)
+  {
+    if constexpr (direct_table) {
+      return static_cast<uint8_t>(c);
+    } else {
+      return c;
+    }
+  }
+
+  rank_type
+  rank(const C c) const
+  {
+    if constexpr (direct_table) {
+      return (*m_ranks)[index(c)];
+    } else {
+      const auto it = m_ranks->find(c);
+      return it == m_ranks->end() ? unranked : it->second;
+    }
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Whether `a` is ordered before `b`.
+  //////////////////////////////////////////////////////////////////////////////
+  bool
+  operator()(const C &a, const C &b) const
+  {
+    if (m_ranks) {
+      const rank_type rank_a = rank(a);
+      const rank_type rank_b = rank(b);
+      if (rank_a != rank_b) { return rank_a < rank_b; }
+    }
+    return a < b;
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Ordering of a fixed alphabet, known at compile-time, e.g. to be
+///        used as the `Compare` of `anatree<...>`.
+///
+/// \details The letters are ordered as they are given, e.g.
+///          `alphabet<'A', 'C', 'G', 'T'>`. Each letter is mapped to its dense
+///          index with a lookup table that is built at compile-time. Keys of
+///          words with only letters of the alphabet are sorted with a counting
+///          sort over these indices. Characters outside of the alphabet are
+///          placed after all letters (in their natural order).
+///
+///          NIL nodes are marked with a character that is not a letter. Hence,
+///          the alphabet may include the character 0.
+///
+/// \see alphabet_range
+///
+/// \tparam Cs Letters of the alphabet (all of the same type and distinct). At
+///            least one value of their type must be left over for NIL nodes.
+////////////////////////////////////////////////////////////////////////////////
+template<auto... Cs>
+requires (0u < sizeof...(Cs))
+      && (std::is_same_v<decltype(Cs), std::common_type_t<decltype(Cs)...>> && ...)
+class alphabet
+{
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Type of each individual character.
+  //////////////////////////////////////////////////////////////////////////////
+  using value_type = std::common_type_t<decltype(Cs)...>;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of letters.
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr size_t size = sizeof...(Cs);
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief All letters in order.
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr std::array<value_type, size> letters = { Cs... };
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of bits needed for the index of a letter, e.g. 2 for the
+  ///        letters 'ACGT' and 5 for 'a' to 'z'.
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr size_t bits = std::bit_width(size - 1u);
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Letters sorted by their value together with their index, for
+  ///        characters that are too wide for a lookup table.
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr std::array<std::pair<value_type, size_t>, size> sorted_letters = []() {
+    std::array<std::pair<value_type, size_t>, size> res;
+    for (size_t i = 0u; i < size; ++i) { res[i] = { letters[i], i }; }
+    std::sort(res.begin(), res.end());
+    return res;
+  }();
+
+  static_assert(std::adjacent_find(sorted_letters.begin(), sorted_letters.end(),
+                                   [](const auto &a, const auto &b) { return a.first == b.first; })
+                == sorted_letters.end(),
+                "The letters of an alphabet must be distinct");
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Whether characters are mapped with a lookup table of all values.
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr bool use_table = sizeof(value_type) == 1u;
+
+  using index_type = std::conditional_t<size < 255u, uint8_t, uint16_t>;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Index of each byte-sized character (`size` for non-letters).
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr std::array<index_type, 256u> table = []() {
+    std::array<index_type, 256u> res;
+    res.fill(static_cast<index_type>(size));
+    if constexpr (use_table) {
+      for (size_t i = 0u; i < size; ++i) {
+        res[static_cast<uint8_t>(letters[i])] = static_cast<index_type>(i);
+      }
+    }
+    return res;
+  }();
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Position of each byte-sized character within the order, i.e. the
+  ///        letters followed by all other characters in their natural order.
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr std::array<uint8_t, 256u> ranks = []() {
+    std::array<uint8_t, 256u> res = { };
+    if constexpr (use_table) {
+      size_t next = size;
+      for (int v = std::numeric_limits<value_type>::min(); v <= std::numeric_limits<value_type>::max(); ++v) {
+        const uint8_t c = static_cast<uint8_t>(static_cast<value_type>(v));
+        res[c] = table[c] < size ? table[c] : next++;
+      }
+    }
+    return res;
+  }();
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Dense index of the letter `c`, or `size` if it is not a letter.
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr size_t
+  index_of(const value_type c)
+  {
+    if constexpr (use_table) {
+      return table[static_cast<uint8_t>(c)];
+    } else {
+      const auto it = std::lower_bound(sorted_letters.begin(), sorted_letters.end(), c,
+                                       [](const auto &l, const value_type v) { return l.first < v; });
+      return it != sorted_letters.end() && it->first == c ? it->second : size;
+    }
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Whether `c` is a letter of the alphabet.
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr bool
+  contains(const value_type c)
+  {
+    return index_of(c) < size;
+  }
+
+  static_assert(sizeof(value_type) >= sizeof(size_t)
+                || size < (size_t(1u) << (8u * sizeof(value_type))),
+                "An alphabet must leave at least one value of its character type unused");
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Character (closest to 0) that is not a letter, used to mark NIL
+  ///        nodes.
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr value_type nil = []() {
+    value_type c = 0;
+    while (contains(c)) { ++c; }
+    return c;
+  }();
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Whether `a` is ordered before `b`.
+  //////////////////////////////////////////////////////////////////////////////
+  constexpr bool
+  operator()(const value_type a, const value_type b) const
+  {
+    if constexpr (use_table) {
+      return ranks[static_cast<uint8_t>(a)] < ranks[static_cast<uint8_t>(b)];
+    } else {
+      const size_t index_a = index_of(a);
+      const size_t index_b = index_of(b);
+      if (index_a != index_b) { return index_a < index_b; }
+      return a < b;
+    }
+  }
+};
+
+namespace anatree_internal
+{
+  template<auto First, typename Seq>
+  struct alphabet_range_impl;
+
+  template<auto First, size_t... Is>
+  struct alphabet_range_impl<First, std::index_sequence<Is...>>
+  {
+    using type = alphabet<static_cast<decltype(First)>(First + Is)...>;
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief The `alphabet<...>` of all characters from `First` to `Last`
+///        (inclusive) in their natural order, e.g. `alphabet_range<'a', 'z'>`.
+////////////////////////////////////////////////////////////////////////////////
+template<auto First, auto Last>
+requires std::is_same_v<decltype(First), decltype(Last)> && (First <= Last)
+using alphabet_range = typename anatree_internal::alphabet_range_impl<
+  First, std::make_index_sequence<static_cast<size_t>(Last - First) + 1u>
+>::type;
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Hash of words that also accepts views of them, e.g. to be used for
+///        the `Set` of `anatree<...>` together with `std::equal_to<>`.
+///
+/// \details With this, words given as a view are looked up without first
+///          constructing a word of type `T` from them.
+///
+/// \tparam T Type of words, e.g. `std::string`.
+////////////////////////////////////////////////////////////////////////////////
+template<typename T>
+struct transparent_hash
+{
+  using is_transparent = void;
+
+  using view_type = std::basic_string_view<typename T::value_type>;
+
+  size_t
+  operator() (const view_type w) const
+  {
+    return std::hash<view_type>()(w);
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Immutable and compact Anatree, see `anatree<...>::freeze()`.
+////////////////////////////////////////////////////////////////////////////////
+template<typename T       = std::string,
+         typename Compare = std::less<typename T::value_type>,
+         typename Set     = std::unordered_set<T>>
+class frozen_anatree;
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief A data structure capable of storing a set of 'std::string' (or
+///        similar) data structures, enabling quick access to all 'anagrams' of
+///        each word (within or not).
+///
+/// \tparam T       Type for words, i.e. lists of elemnts. This type should
+///                 provide the interface of `std::string`, such as
+///                 `std::basic_string<_>` and `std::vector<_>`.
+///
+/// \tparam Compare Ordering of the symbols within each word. The order has a
+///                 major impact on the size.
+///
+/// \tparam Set     Type to be used for storing and returning sets of words.
+///
+/// \tparam Map     Type to be used for storing pairs `T`. This is not used
+///                 anymore, but kept for source compatibility.
+////////////////////////////////////////////////////////////////////////////////
+template<typename T       = std::string,
+         typename Compare = std::less<typename T::value_type>,
+         typename Set     = std::unordered_set<T>,
+         typename Map     = std::unordered_map<T, T>>
+requires std::copyable<T>
+      && std::sortable<typename T::iterator, Compare>
+      && std::equality_comparable<typename T::value_type>
+      && std::totally_ordered<typename T::value_type>
+class anatree
+{
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Type of each individual character.
+  //////////////////////////////////////////////////////////////////////////////
+  using value_type = typename T::value_type;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Non-owning view of a word, e.g. `std::string_view`.
+  //////////////////////////////////////////////////////////////////////////////
+  using view_type = std::basic_string_view<value_type>;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Sorted characters of a word.
+  //////////////////////////////////////////////////////////////////////////////
+  using key_type = anatree_internal::key_buffer<value_type>;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Iterator for the characters of a key.
+  //////////////////////////////////////////////////////////////////////////////
+  using key_iterator = const value_type*;
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Set of characters, where each character is hashed to one of 64
+  ///        bits (see `char_bit`).
+  //////////////////////////////////////////////////////////////////////////////
+  using char_mask = uint64_t;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief The bit of character `c` in a `char_mask`.
+  ///
+  /// \details Since several characters can share a bit, a missing bit proves a
+  ///          character to be absent but a set bit does not prove it to be
+  ///          present. Characters that are not integral all share all bits.
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr char_mask
+  char_bit(const value_type c)
+  {
+    if constexpr (std::is_integral_v<value_type>) {
+      return char_mask(1u) << (static_cast<uint64_t>(c) % 64u);
+    } else {
+      return ~char_mask(0u);
+    }
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief The set of characters in a word.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename W>
+  static char_mask
+  char_mask_of(const W &w)
+  {
+    char_mask res = 0u;
+    for (const value_type c : w) { res |= char_bit(c); }
+    return res;
+  }
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Individual node of the Anatree.
+  ///
+  /// \details Nodes are not allocated individually on the heap but are carved
+  ///          out of the Anatree's node arena, `m_nodes`. Hence, children are
+  ///          identified by their 32-bit index within the arena.
+  ///
+  ///          All empty NIL leaves are represented by the single shared (and
+  ///          immutable) sentinel `node::nil` at index 0. The set of words is
+  ///          likewise stored out-of-line in `m_word_sets` and only created
+  ///          when the first word is attached to a node.
+  //////////////////////////////////////////////////////////////////////////////
+  class node
+  {
+  public:
+    using ptr = uint32_t;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Index that does not refer to any node.
+    ////////////////////////////////////////////////////////////////////////////
+    static constexpr ptr null = std::numeric_limits<ptr>::max();
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Index of the shared NIL leaf without any words.
+    ////////////////////////////////////////////////////////////////////////////
+    static constexpr ptr nil = 0u;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Index of the shared empty set of words.
+    ////////////////////////////////////////////////////////////////////////////
+    static constexpr ptr no_words = 0u;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Character of NIL nodes (see `anatree_internal::nil_char`).
+    ////////////////////////////////////////////////////////////////////////////
+    static constexpr value_type NIL = anatree_internal::nil_char<value_type, Compare>();
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Character in this node
+    ////////////////////////////////////////////////////////////////////////////
+    value_type m_char = NIL;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Binary choice on children.
+    ///
+    /// Follow the 'false' index, if 'm_char' does not occur in the word.
+    /// Otherwise follow the 'true' index, if it does.
+    ////////////////////////////////////////////////////////////////////////////
+    ptr m_children[2] = { nil, nil };
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Index of the set of words that are anagrams of the path up to
+    ///        this node.
+    ////////////////////////////////////////////////////////////////////////////
+    ptr m_words = no_words;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Number of words stored in the subtree of this node (including
+    ///        this node itself).
+    ////////////////////////////////////////////////////////////////////////////
+    size_t m_subtree_words = 0u;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Largest number of 'true' edges from this node to a word in its
+    ///        subtree, i.e. how many letters the longest word below consumes.
+    ////////////////////////////////////////////////////////////////////////////
+    size_t m_max_length = 0u;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    std::string to_string() const
+    {
+      std::stringstream ss;
+      ss << "{ char: " << m_char
+         << ", children: { " << m_children[false] << ", " << m_children[true]
+         << " }, words: " << m_words << " }";
+      return ss.str();
+    }
+  };
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Alias for 'node::ptr' that allows omitting the 'typename' keyword.
+  //////////////////////////////////////////////////////////////////////////////
+  using node_ptr = typename node::ptr;
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Comparator for characters.
+  //////////////////////////////////////////////////////////////////////////////
+  Compare m_char_comp = Compare();
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Arena of all nodes in the tree. All nodes are released at once
+  ///        when the arena is cleared or destructed.
+  ///
+  /// \details The first entry is the shared NIL leaf, `node::nil`.
+  //////////////////////////////////////////////////////////////////////////////
+  anatree_internal::cow_array<node> m_nodes = anatree_internal::cow_array<node>(1);
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Sets of words of all nodes that (have) had a word attached.
+  ///
+  /// \details The first entry is the shared empty set, `node::no_words`.
+  //////////////////////////////////////////////////////////////////////////////
+  anatree_internal::cow_array<Set> m_word_sets = anatree_internal::cow_array<Set>(1);
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Entries in `m_nodes` that have been released by `erase(w)` and can
+  ///        be reused.
+  //////////////////////////////////////////////////////////////////////////////
+  std::vector<node_ptr> m_free_nodes;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Entries in `m_word_sets` that have been released by `erase(w)` and
+  ///        can be reused.
+  //////////////////////////////////////////////////////////////////////////////
+  std::vector<node_ptr> m_free_word_sets;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Root of the anatree (initially the NIL leaf).
+  ///
+  /// \details Once the root is a concrete node, it is never moved, since new
+  ///          nodes above it are instead spliced in by moving its content
+  ///          further down.
+  //////////////////////////////////////////////////////////////////////////////
+  node_ptr m_root = node::nil;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of words stored within this tree.
+  //////////////////////////////////////////////////////////////////////////////
+  size_t m_size = 0u;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief (Superset of the) characters in all stored words.
+  ///
+  /// \details This is not shrunk by `erase(w)`.
+  //////////////////////////////////////////////////////////////////////////////
+  char_mask m_alphabet = 0u;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of nodes (including NIL) in the tree.
+  //////////////////////////////////////////////////////////////////////////////
+  size_t m_tree_size = 1u;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Version of the words in the tree (see `epoch()`).
+  //////////////////////////////////////////////////////////////////////////////
+  uint64_t m_epoch = 0u;
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Constructor of an empty Anatree.
+  //////////////////////////////////////////////////////////////////////////////
+  constexpr
+  anatree(Compare char_comp = Compare())
+    : m_char_comp(char_comp)
+  { }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Copy-constructor, creating a copy-on-write copy of another
+  ///        Anatree.
+  ///
+  /// \details Both trees share all nodes and sets of words (in pages of
+  ///          `anatree_internal::cow_array<...>::page_size` entries) until
+  ///          either of them changes them. Hence, an update of either tree
+  ///          leaves the other one unaffected. The first change to a node (or
+  ///          set of words) after the copy duplicates its entire page.
+  ///
+  /// \remark Requires \f$O(N / \mathit{page\_size})\f$ time and memory for
+  ///         the copy, plus one page per node touched by later updates.
+  //////////////////////////////////////////////////////////////////////////////
+  constexpr
+  anatree(const anatree &a) = default;
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Allocate a new (concrete) NIL node in the arena.
+  ///
+  /// \details This does not invalidate references to other nodes, since the
+  ///          pages of the arena are never moved.
+  //////////////////////////////////////////////////////////////////////////////
+  node_ptr
+  make_node()
+  {
+    if (!m_free_nodes.empty()) {
+      const node_ptr p = m_free_nodes.back();
+      m_free_nodes.pop_back();
       return p;
     }
 
-    // Case: Iterator behind
-    // -> Insert new node in-between
-    if (m_char_comp(*curr, p->m_char)) {
-      // Hand over ownership of 'p' to a new node 'np'. The original node 'p' is
-      // now available as its 'false' child.
-      node_ptr np = node::make_node(*curr, std::move(p), node::make_node());
-      np->m_words = std::move(np->m_children[false]->m_words);
-      np->m_children[false]->m_words = Set();
-      m_tree_size += 2; // <- new node and its NIL 'false' child
-      np->m_children[true]  = insert__rec(std::move(np->m_children[true]), w, ++curr, end);
-      return std::move(np);
-    }
-
-    // Case: Iterator ahead
-    // -> Follow 'false' child
-    if (m_char_comp(p->m_char, *curr)) {
-      p->m_children[false] = insert__rec(std::move(p->m_children[false]), w, curr, end);
-      return p;
+    assert(m_nodes.size() < node::null);
+    const node_ptr p = m_nodes.size();
+    m_nodes.emplace_back();
+    return p;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Release the concrete node `p` (without any words) for reuse.
+  //////////////////////////////////////////////////////////////////////////////
+  void
+  free_node(const node_ptr p)
+  {
+    assert(p != node::nil);
+    assert(m_nodes[p].m_words == node::no_words);
+    m_nodes.mut(p) = node();
+    m_free_nodes.push_back(p);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief The set of words stored at node `p`.
+  //////////////////////////////////////////////////////////////////////////////
+  const Set&
+  words_of(const node_ptr p) const
+  {
+    return m_word_sets[m_nodes[p].m_words];
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Mutable access to the set of words stored at the concrete node
+  ///        `p`, creating the set if it does not exist yet.
+  //////////////////////////////////////////////////////////////////////////////
+  Set&
+  make_words_of(const node_ptr p)
+  {
+    assert(p != node::nil);
+    if (m_nodes[p].m_words == node::no_words) {
+      if (!m_free_word_sets.empty()) {
+        m_nodes.mut(p).m_words = m_free_word_sets.back();
+        m_free_word_sets.pop_back();
+      } else {
+        assert(m_word_sets.size() < node::null);
+        m_nodes.mut(p).m_words = m_word_sets.size();
+        m_word_sets.emplace_back();
+      }
+    }
+    return m_word_sets.mut(m_nodes[p].m_words);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Release the (empty) set of words of the concrete node `p`.
+  //////////////////////////////////////////////////////////////////////////////
+  void
+  free_words_of(const node_ptr p)
+  {
+    const node_ptr ws = m_nodes[p].m_words;
+    assert(ws != node::no_words && m_word_sets[ws].size() == 0u);
+
+    m_word_sets.mut(ws) = Set(); // <- release its buckets
+    m_free_word_sets.push_back(ws);
+    m_nodes.mut(p).m_words = node::no_words;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Recompute the statistics of the concrete node `p` from the ones of
+  ///        its children.
+  //////////////////////////////////////////////////////////////////////////////
+  void
+  update_stats(const node_ptr p)
+  {
+    node &n = m_nodes.mut(p);
+    const node &n_false = m_nodes[n.m_children[false]];
+    const node &n_true  = m_nodes[n.m_children[true]];
+
+    n.m_subtree_words = words_of(p).size() + n_false.m_subtree_words + n_true.m_subtree_words;
+    n.m_max_length = n.m_char == node::NIL
+      ? 0u
+      : std::max(n_false.m_max_length, n_true.m_max_length + 1u);
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Move-constructor, taking over ownership of the other's tree.
+  //////////////////////////////////////////////////////////////////////////////
+  constexpr
+  anatree(anatree&&) = default;
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Contruct a tree containing all of the given words.
+  ///
+  /// \details The tree is built in a single pass over all words, after the
+  ///          key of each word has been sorted and all keys have been sorted.
+  //////////////////////////////////////////////////////////////////////////////
+  template <typename InputIt>
+  requires std::input_iterator<InputIt>
+        && (std::is_convertible<typename InputIt::value_type, T>::value
+            || std::is_same<typename InputIt::value_type, view_type>::value)
+  constexpr
+  anatree(InputIt first, InputIt last, Compare char_comp = Compare())
+    : anatree(char_comp)
+  {
+    insert(first, last);
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief The `tree_size()` of an Anatree with the given words and ordering
+  ///        of characters, e.g. to compare the strategies of
+  ///        `frequency_order<...>`.
+  ///
+  /// \details The size is computed from the sorted keys of all words without
+  ///          creating any of the nodes.
+  //////////////////////////////////////////////////////////////////////////////
+  template <typename InputIt>
+  requires std::input_iterator<InputIt>
+        && std::is_convertible<typename InputIt::value_type, T>::value
+  static size_t
+  tree_size_of(InputIt first, InputIt last, const Compare char_comp = Compare())
+  {
+    std::vector<T> keys;
+    for (; first != last; ++first) {
+      T key = *first;
+      anatree_internal::sort_chars(key.begin(), key.end(), char_comp);
+      keys.push_back(std::move(key));
+    }
+
+    std::sort(keys.begin(), keys.end(), [&char_comp](const T &a, const T &b) {
+      return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(),
+                                          std::cref(char_comp));
+    });
+
+    // Split the sorted keys in the same way as `bulk_insert` and count the
+    // number of nodes with a character, each of which adds two children.
+    std::vector<std::tuple<size_t, size_t, size_t>> stack;
+    if (!keys.empty()) {
+      stack.push_back({ 0u, keys.size(), 0u });
+    }
+
+    size_t tree_size = 1u;
+    while (!stack.empty()) {
+      const auto [begin, end, depth] = stack.back();
+      stack.pop_back();
+
+      size_t i = begin;
+      while (i < end && keys[i].size() == depth) { ++i; }
+      if (i == end) { continue; }
+
+      tree_size += 2u;
+
+      const typename T::value_type c = keys[i][depth];
+      size_t j = i;
+      while (j < end && !char_comp(c, keys[j][depth])) { ++j; }
+
+      if (j < end) { stack.push_back({ j, end, depth }); }
+      stack.push_back({ i, j, depth+1u });
+    }
+    return tree_size;
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Adds the word 'w' to the anatree.
+  //////////////////////////////////////////////////////////////////////////////
+  void
+  insert(const T &w)
+  {
+    insert__word(w);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Adds the word 'w' to the anatree by moving it into the tree.
+  //////////////////////////////////////////////////////////////////////////////
+  void
+  insert(T &&w)
+  {
+    insert__word(std::move(w));
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Adds the word 'w' to the anatree.
+  ///
+  /// \details A word of type `T` is only created from 'w', if it is not
+  ///          already in the tree.
+  //////////////////////////////////////////////////////////////////////////////
+  template<std::same_as<view_type> V>
+  void
+  insert(const V w)
+  {
+    insert__word(w);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Adds the word constructed in-place from `args` to the anatree.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename... Args>
+  requires std::constructible_from<T, Args&&...>
+  void
+  emplace(Args&&... args)
+  {
+    insert__word(T(std::forward<Args>(args)...));
+  }
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Whether `words` includes the word 'w'.
+  ///
+  /// \details If `Set` does not support lookups with the type of 'w', e.g. a
+  ///          view without a transparent hash, then a word of type `T` is
+  ///          created for the lookup.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename W>
+  static bool
+  contains_word(const Set &words, const W &w)
+  {
+    if constexpr (std::same_as<W, T> || requires { words.contains(w); }) {
+      return words.contains(w);
+    } else {
+      return words.contains(T(w.begin(), w.end()));
+    }
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Adds the word 'w' (of type `T` or `view_type`) to the anatree.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename W>
+  void
+  insert__word(W &&w)
+  {
+    const key_type key = sorted_key(w);
+    const node_ptr p = insert_node(key);
+
+    Set &words = make_words_of(p);
+    if (!contains_word(words, w)) {
+      m_epoch = anatree_internal::next_epoch();
+      m_size++;
+      m_alphabet |= char_mask_of(key);
+      if constexpr (std::same_as<std::remove_cvref_t<W>, T>) {
+        words.insert(std::forward<W>(w));
+      } else {
+        words.insert(T(w.begin(), w.end()));
+      }
+      add_to_stats(key);
+    }
+  }
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Obtain the (concrete) node for the given key, creating it and all
+  ///        nodes on the path to it, if necessary.
+  ///
+  /// \details The tree is changed in-place while walking down the path. Only
+  ///          the link of the parent to a newly materialized node is updated.
+  //////////////////////////////////////////////////////////////////////////////
+  node_ptr
+  insert_node(const key_type &key)
+  {
+    key_iterator curr = key.begin();
+    const key_iterator end = key.end();
+
+    node_ptr parent = node::null;
+    bool side = false;
+    node_ptr p = m_root;
+
+    while (true) {
+      // Case: Shared NIL leaf
+      // -> Materialize a concrete node to attach the word or children to.
+      if (p == node::nil) {
+        p = make_node();
+        if (parent == node::null) {
+          m_root = p;
+        } else {
+          m_nodes.mut(parent).m_children[side] = p;
+        }
+      }
+
+      // Case: Iterator done
+      // -> Found node for word
+      if (curr == end) {
+        return p;
+      }
+
+      node &n = m_nodes.mut(p);
+
+      // Case: NIL
+      // -> Turn into non-NIL node
+      if (n.m_char == node::NIL) {
+        assert(n.m_children[false] == node::nil
+               && n.m_children[true] == node::nil);
+        n.m_char = *curr;
+        m_tree_size += 2; // <- NIL 'false' and 'true' children
+
+        parent = p;
+        side = true;
+        p = node::nil;
+        ++curr;
+        continue;
+      }
+
+      // Case: Iterator behind
+      // -> Insert new node in-between
+      if (m_char_comp(*curr, n.m_char)) {
+        // Move the content of 'p' into a new node 'np' which is then placed as
+        // the 'false' child of 'p'. This way, no pointer to 'p' needs to be
+        // updated. The words stay with 'p'.
+        const node_ptr np = make_node();
+
+        m_nodes.mut(np).m_char = m_nodes[p].m_char;
+        m_nodes.mut(np).m_children[false] = m_nodes[p].m_children[false];
+        m_nodes.mut(np).m_children[true]  = m_nodes[p].m_children[true];
+
+        m_nodes.mut(np).m_subtree_words = m_nodes[p].m_subtree_words - words_of(p).size();
+        m_nodes.mut(np).m_max_length = m_nodes[p].m_max_length;
+
+        m_nodes.mut(p).m_char = *curr;
+        m_nodes.mut(p).m_children[false] = np;
+        m_nodes.mut(p).m_children[true]  = node::nil;
+
+        m_tree_size += 2; // <- new node and its NIL 'true' child
+
+        parent = p;
+        side = true;
+        p = node::nil;
+        ++curr;
+        continue;
+      }
+
+      // Case: Iterator ahead
+      // -> Follow 'false' child
+      if (m_char_comp(n.m_char, *curr)) {
+        parent = p;
+        side = false;
+        p = n.m_children[false];
+        continue;
+      }
+
+      // Case: Iterator and node matches
+      // -> Follow 'true' child
+      parent = p;
+      side = true;
+      p = n.m_children[true];
+      ++curr;
+    }
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Account for a new word with the given key in the statistics of
+  ///        all nodes on the (existing) path to it.
+  //////////////////////////////////////////////////////////////////////////////
+  void
+  add_to_stats(const key_type &key)
+  {
+    key_iterator curr = key.begin();
+    node_ptr p = m_root;
+
+    while (true) {
+      assert(p != node::nil);
+      node &n = m_nodes.mut(p);
+
+      n.m_subtree_words += 1u;
+      n.m_max_length = std::max<size_t>(n.m_max_length, key.end() - curr);
+
+      if (curr == key.end()) { return; }
+
+      assert(!m_char_comp(*curr, n.m_char));
+      if (m_char_comp(n.m_char, *curr)) {
+        p = n.m_children[false];
+      } else {
+        p = n.m_children[true];
+        ++curr;
+      }
+    }
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Adds the words to the anatree as per the iterator.
+  ///
+  /// \details If the Anatree is empty, then it is built bottom-up in a single
+  ///          pass (see `anatree(first, last)`). Otherwise, each word is
+  ///          inserted individually.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename InputIt>
+  requires std::input_iterator<InputIt>
+        && (std::is_convertible<typename InputIt::value_type, T>::value
+            || std::is_same<typename InputIt::value_type, view_type>::value)
+  void
+  insert(InputIt begin, InputIt end)
+  {
+    if (m_root == node::nil) {
+      bulk_insert(begin, end);
+      return;
+    }
+    while (begin != end) { insert(*(begin++)); }
+  }
+
+private:
+  template<typename InputIt>
+  void
+  bulk_insert(InputIt begin, InputIt end)
+  {
+    assert(m_root == node::nil);
+    assert(m_free_nodes.empty());
+
+    m_epoch = anatree_internal::next_epoch();
+
+    // Sort the characters of every word once and then sort all words by their
+    // key. This way, all words in the subtree of a node are consecutive.
+    std::vector<std::pair<T, T>> entries;
+    while (begin != end) {
+      T w(*(begin++));
+      T key = sorted_word(w);
+      entries.emplace_back(std::move(key), std::move(w));
+    }
+
+    const auto key_lt = [this](const std::pair<T, T> &a, const std::pair<T, T> &b) {
+      return std::lexicographical_compare(a.first.begin(), a.first.end(),
+                                          b.first.begin(), b.first.end(),
+                                          m_char_comp);
+    };
+    std::sort(entries.begin(), entries.end(), key_lt);
+
+    // Build the tree top-down with an explicit stack of the range of words in
+    // each subtree, the number of characters already consumed by its path, and
+    // the parent (together with which child it is).
+    struct frame
+    {
+      size_t begin;
+      size_t end;
+      size_t depth;
+      node_ptr parent;
+      bool side;
+    };
+
+    std::vector<frame> stack;
+    if (!entries.empty()) {
+      stack.push_back({ 0u, entries.size(), 0u, node::null, false });
+    }
+
+    while (!stack.empty()) {
+      const frame f = stack.back();
+      stack.pop_back();
+
+      const node_ptr p = make_node();
+      if (f.parent == node::null) {
+        m_root = p;
+      } else {
+        m_nodes.mut(f.parent).m_children[f.side] = p;
+      }
+
+      // Case: Key done
+      // -> Insert word (these are sorted before all longer keys)
+      size_t i = f.begin;
+      for (; i < f.end && entries[i].first.size() == f.depth; ++i) {
+        Set &words = make_words_of(p);
+        if (!words.contains(entries[i].second)) {
+          m_size++;
+          m_alphabet |= char_mask_of(entries[i].first);
+          words.insert(std::move(entries[i].second));
+        }
+      }
+
+      // Case: No more keys
+      // -> Leave it as a leaf
+      if (i == f.end) { continue; }
+
+      // Case: Keys remain
+      // -> The smallest next character is the one of this node. The words that
+      //    include it are the ones up to 'j'.
+      const value_type c = entries[i].first[f.depth];
+
+      size_t j = i;
+      while (j < f.end && !m_char_comp(c, entries[j].first[f.depth])) { ++j; }
+
+      m_nodes.mut(p).m_char = c;
+      m_tree_size += 2; // <- 'false' and 'true' children
+
+      // Push 'false' child first, such that the 'true' child is placed next.
+      if (j < f.end) {
+        stack.push_back({ j, f.end, f.depth, p, false });
+      }
+      stack.push_back({ i, j, f.depth+1, p, true });
+    }
+
+    // Every child is created after its parent. Hence, the statistics can be
+    // computed bottom-up by a single backwards sweep over the arena.
+    for (node_ptr p = m_nodes.size() - 1u; p != node::nil; --p) {
+      assert(m_nodes[p].m_children[false] == node::nil || p < m_nodes[p].m_children[false]);
+      assert(m_nodes[p].m_children[true]  == node::nil || p < m_nodes[p].m_children[true]);
+
+      update_stats(p);
+    }
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Remove all nodes/anagrams.
+  //////////////////////////////////////////////////////////////////////////////
+  void
+  clear()
+  {
+    m_nodes = anatree_internal::cow_array<node>(1);
+    m_word_sets = anatree_internal::cow_array<Set>(1);
+    m_free_nodes = std::vector<node_ptr>();
+    m_free_word_sets = std::vector<node_ptr>();
+    m_root = node::nil;
+    m_size = 0u;
+    m_alphabet = 0u;
+    m_tree_size = 1u;
+    m_epoch = anatree_internal::next_epoch();
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Removes the word 'w' from the Anatree.
+  ///
+  /// \details Nodes whose subtree has no words left are removed and the tree is
+  ///          restored to the shape it would have had, if 'w' was never
+  ///          inserted. If more than half of the node arena is unused
+  ///          afterwards, then it is compacted (see `shrink_to_fit()`).
+  ///
+  /// \returns Number of words removed (0 or 1).
+  //////////////////////////////////////////////////////////////////////////////
+  size_t
+  erase(const T &w)
+  {
+    return erase__word(w);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Removes the word 'w' from the Anatree, see `erase(const T &w)`.
+  ///
+  /// \details A word of type `T` is only created from 'w', if it is in the
+  ///          tree and `Set` does not support erasing views.
+  ///
+  /// \returns Number of words removed (0 or 1).
+  //////////////////////////////////////////////////////////////////////////////
+  template<std::same_as<view_type> V>
+  size_t
+  erase(const V w)
+  {
+    return erase__word(w);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Removes all the words as per the iterator.
+  ///
+  /// \returns Number of words removed.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename InputIt>
+  requires std::input_iterator<InputIt>
+        && std::is_convertible<typename InputIt::value_type, T>::value
+  size_t
+  erase(InputIt begin, InputIt end)
+  {
+    size_t res = 0u;
+    while (begin != end) { res += erase(*(begin++)); }
+    return res;
+  }
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Removes the word 'w' (of type `T` or `view_type`) from the Anatree.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename W>
+  size_t
+  erase__word(const W &w)
+  {
+    const key_type key = sorted_key(w);
+
+    // Find the path to the node of 'w' together with which child was taken at
+    // each node along the way.
+    std::vector<std::pair<node_ptr, bool>> path;
+
+    node_ptr p = m_root;
+    for (key_iterator curr = key.begin(); curr != key.end();) {
+      const node &n = m_nodes[p];
+
+      // Case: Iterator behind or tree is done
+      // -> 'w' is not in the tree
+      if (m_char_comp(*curr, n.m_char) || n.m_char == node::NIL) {
+        return 0u;
+      }
+
+      // Case: Iterator ahead
+      // -> Follow 'false' child
+      const bool side = !m_char_comp(n.m_char, *curr);
+      path.push_back({ p, side });
+      p = n.m_children[side];
+
+      // Case: Iterator and node matches
+      // -> Follow 'true' child
+      if (side) { ++curr; }
+    }
+
+    if (p == node::nil || !contains_word(words_of(p), w)) {
+      return 0u;
+    }
+
+    Set &words = make_words_of(p);
+    if constexpr (std::same_as<W, T> || requires { words.erase(w); }) {
+      words.erase(w);
+    } else {
+      words.erase(T(w.begin(), w.end()));
+    }
+    m_size--;
+    m_epoch = anatree_internal::next_epoch();
+
+    // Case: Tree is empty
+    // -> Release everything
+    if (m_size == 0u) {
+      clear();
+      return 1u;
+    }
+
+    if (words_of(p).size() == 0u) {
+      free_words_of(p);
+    }
+    path.push_back({ p, false });
+
+    // Walk back up, collapsing nodes and updating their statistics.
+    for (size_t i = path.size(); 0u < i--;) {
+      const node_ptr q = path[i].first;
+      node &n = m_nodes.mut(q);
+
+      // Case: 'true' subtree has become empty
+      // -> Move the content of the 'false' child into 'q' (the inverse of
+      //    splicing in a node when inserting). The words stay with 'q'.
+      if (n.m_char != node::NIL && n.m_children[true] == node::nil) {
+        const node_ptr q_false = n.m_children[false];
+
+        if (q_false != node::nil) {
+          n.m_char = m_nodes[q_false].m_char;
+          n.m_children[false] = m_nodes[q_false].m_children[false];
+          n.m_children[true]  = m_nodes[q_false].m_children[true];
+          free_node(q_false);
+        } else {
+          n.m_char = node::NIL;
+        }
+        m_tree_size -= 2; // <- removed node and NIL 'true' child
+      }
+
+      // Case: Empty leaf
+      // -> Replace with the shared NIL leaf
+      if (n.m_char == node::NIL && n.m_words == node::no_words) {
+        free_node(q);
+
+        assert(0u < i);
+        const auto [parent, side] = path[i-1];
+        m_nodes.mut(parent).m_children[side] = node::nil;
+        continue;
+      }
+
+      update_stats(q);
+    }
+
+    if (m_nodes.size() > 64u && m_nodes.size() < 2u * m_free_nodes.size()) {
+      shrink_to_fit();
+    }
+    return 1u;
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Adds all words of `other` to this Anatree.
+  ///
+  /// \details Both trees are traversed simultaneously, aligned by the
+  ///          characters of their nodes. Subtrees and sets of words that only
+  ///          exist in `other` are moved over, while the ones only in this
+  ///          tree are left untouched. Hence, this is much faster than
+  ///          inserting every word of `other`. Afterwards, `other` is empty.
+  ///
+  /// \pre Both trees use the same ordering of characters.
+  //////////////////////////////////////////////////////////////////////////////
+  void
+  merge(anatree &&other)
+  {
+    if (&other == this) { return; }
+    m_alphabet |= other.m_alphabet;
+    m_epoch = anatree_internal::next_epoch();
+
+    // Depth-first traversal with an explicit stack of the pair of nodes, where
+    // the (merged) node is linked in, and whether the words of 'q' are still
+    // to be moved.
+    struct frame
+    {
+      node_ptr p;
+      node_ptr q;
+      node_ptr parent;
+      bool side;
+      bool with_words;
+    };
+
+    std::vector<frame> stack;
+    stack.push_back({ m_root, other.m_root, node::null, false, true });
+
+    // Nodes of this tree that are changed, parents before their children.
+    std::vector<node_ptr> changed;
+
+    while (!stack.empty()) {
+      const frame f = stack.back();
+      stack.pop_back();
+
+      // Case: Nothing in 'other'
+      // -> Keep 'p' as it is.
+      if (f.q == node::nil) { continue; }
+
+      // Case: Nothing in this tree
+      // -> Move the entire subtree of 'q' over.
+      if (f.p == node::nil) {
+        const node_ptr np = move_subtree(other, f.q, f.with_words);
+        if (f.parent == node::null) {
+          m_root = np;
+        } else {
+          m_nodes.mut(f.parent).m_children[f.side] = np;
+        }
+        continue;
+      }
+
+      const node_ptr p = f.p;
+      changed.push_back(p);
+
+      if (f.with_words) { move_words(other, f.q, p); }
+
+      const node &n_q = other.m_nodes[f.q];
+      const value_type c = m_nodes[p].m_char;
+
+      // Case: 'q' is a leaf
+      // -> Nothing but its words to add.
+      if (n_q.m_char == node::NIL) { continue; }
+
+      // Case: 'p' is a leaf
+      // -> Take over the character and the children of 'q'.
+      if (c == node::NIL) {
+        m_nodes.mut(p).m_char = n_q.m_char;
+        m_tree_size += 2; // <- 'false' and 'true' children
+
+        stack.push_back({ node::nil, n_q.m_children[false], p, false, true });
+        stack.push_back({ node::nil, n_q.m_children[true],  p, true,  true });
+        continue;
+      }
+
+      // Case: 'q' is behind
+      // -> Insert a node with its character in-between (see `insert_node`).
+      if (m_char_comp(n_q.m_char, c)) {
+        const node_ptr np = make_node();
+
+        m_nodes.mut(np).m_char = c;
+        m_nodes.mut(np).m_children[false] = m_nodes[p].m_children[false];
+        m_nodes.mut(np).m_children[true]  = m_nodes[p].m_children[true];
+        update_stats(np);
+
+        m_nodes.mut(p).m_char = n_q.m_char;
+        m_nodes.mut(p).m_children[false] = np;
+        m_nodes.mut(p).m_children[true]  = node::nil;
+
+        m_tree_size += 2; // <- new node and its NIL 'true' child
+
+        stack.push_back({ np,        n_q.m_children[false], p, false, true });
+        stack.push_back({ node::nil, n_q.m_children[true],  p, true,  true });
+        continue;
+      }
+
+      // Case: 'q' is ahead
+      // -> All of 'q' (but its words) belongs into the 'false' subtree.
+      if (m_char_comp(c, n_q.m_char)) {
+        stack.push_back({ m_nodes[p].m_children[false], f.q, p, false, false });
+        continue;
+      }
+
+      // Case: 'p' and 'q' match
+      // -> Merge both pairs of children.
+      stack.push_back({ m_nodes[p].m_children[false], n_q.m_children[false], p, false, true });
+      stack.push_back({ m_nodes[p].m_children[true],  n_q.m_children[true],  p, true,  true });
+    }
+
+    // Recompute the statistics bottom-up.
+    for (auto it = changed.rbegin(); it != changed.rend(); ++it) {
+      update_stats(*it);
+    }
+
+    other.clear();
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Adds all words of `other` to this Anatree.
+  ///
+  /// \see merge
+  //////////////////////////////////////////////////////////////////////////////
+  anatree&
+  operator|=(anatree &&other)
+  {
+    merge(std::move(other));
+    return *this;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Adds all words of `other` to this Anatree.
+  ///
+  /// \details This merges a (copy-on-write) copy of `other`.
+  ///
+  /// \see merge
+  //////////////////////////////////////////////////////////////////////////////
+  anatree&
+  operator|=(const anatree &other)
+  {
+    merge(anatree(other));
+    return *this;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Removes all words that are in `other` from this Anatree.
+  ///
+  /// \details Both trees are traversed simultaneously, only following the
+  ///          paths that exist in both of them.
+  ///
+  /// \pre Both trees use the same ordering of characters.
+  //////////////////////////////////////////////////////////////////////////////
+  anatree&
+  operator-=(const anatree &other)
+  {
+    const std::vector<T> common = common_words(other);
+    for (const T &w : common) { erase(w); }
+    return *this;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Removes all words that are not in `other` from this Anatree.
+  ///
+  /// \details Both trees are traversed simultaneously, only following the
+  ///          paths that exist in both of them. The tree is then rebuilt from
+  ///          the words in common (see `anatree(first, last)`).
+  ///
+  /// \pre Both trees use the same ordering of characters.
+  //////////////////////////////////////////////////////////////////////////////
+  anatree&
+  operator&=(const anatree &other)
+  {
+    std::vector<T> common = common_words(other);
+    if (common.size() == m_size) { return *this; }
+
+    clear();
+    bulk_insert(std::make_move_iterator(common.begin()), std::make_move_iterator(common.end()));
+    return *this;
+  }
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Move the words of node `q` in `other` to the (concrete) node `p`.
+  //////////////////////////////////////////////////////////////////////////////
+  void
+  move_words(anatree &other, const node_ptr q, const node_ptr p)
+  {
+    const node_ptr ws = other.m_nodes[q].m_words;
+    if (ws == node::no_words) { return; }
+
+    Set &from = other.m_word_sets.mut(ws);
+
+    // Case: 'p' has no words
+    // -> Move the entire set.
+    if (words_of(p).size() == 0u) {
+      m_size += from.size();
+      make_words_of(p) = std::move(from);
+      return;
+    }
+
+    // Case: Both have words
+    // -> Move (or copy) over the ones 'p' does not have yet.
+    Set &to = make_words_of(p);
+    const size_t size = to.size();
+    anatree_internal::merge_words(to, from);
+    m_size += to.size() - size;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Move the subtree of node `q` in `other` into this tree.
+  ///
+  /// \param with_words Whether to include the words of `q` itself.
+  ///
+  /// \returns The root of the moved subtree.
+  //////////////////////////////////////////////////////////////////////////////
+  node_ptr
+  move_subtree(anatree &other, const node_ptr q, const bool with_words)
+  {
+    // Depth-first traversal with an explicit stack of the node in `other` and
+    // where its copy is linked in (see `shrink_to_fit`).
+    struct frame
+    {
+      node_ptr q;
+      node_ptr parent;
+      bool side;
+    };
+
+    std::vector<frame> stack;
+    stack.push_back({ q, node::null, false });
+
+    node_ptr root = node::nil;
+    while (!stack.empty()) {
+      const frame f = stack.back();
+      stack.pop_back();
+
+      const node &n_q = other.m_nodes[f.q];
+
+      const node_ptr np = make_node();
+      node &n = m_nodes.mut(np);
+      n.m_char          = n_q.m_char;
+      n.m_subtree_words = n_q.m_subtree_words;
+      n.m_max_length    = n_q.m_max_length;
+
+      if (f.parent == node::null) {
+        root = np;
+      } else {
+        m_nodes.mut(f.parent).m_children[f.side] = np;
+      }
+
+      if (f.q != q || with_words) {
+        move_words(other, f.q, np);
+      }
+
+      if (n_q.m_char == node::NIL) { continue; }
+      m_tree_size += 2; // <- 'false' and 'true' children
+
+      // Push 'false' child first, such that the 'true' child is placed next.
+      if (n_q.m_children[false] != node::nil) {
+        stack.push_back({ n_q.m_children[false], np, false });
+      }
+      if (n_q.m_children[true] != node::nil) {
+        stack.push_back({ n_q.m_children[true], np, true });
+      }
+    }
+
+    // The words of 'q' may have been moved elsewhere before. Hence, only the
+    // statistics of its children are certain to be the same as in `other`.
+    update_stats(root);
+    return root;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Copies of all words that are both in this tree and in `other`.
+  ///
+  /// \details Words are only stored at the root or at a 'true' child. Hence,
+  ///          the words of two nodes only need to be compared when both are
+  ///          reached by the same key.
+  //////////////////////////////////////////////////////////////////////////////
+  std::vector<T>
+  common_words(const anatree &other) const
+  {
+    std::vector<T> res;
+
+    std::vector<std::pair<node_ptr, node_ptr>> stack;
+    stack.push_back({ m_root, other.m_root });
+
+    while (!stack.empty()) {
+      const auto [p, q] = stack.back();
+      stack.pop_back();
+
+      // Case: Either tree is done
+      if (p == node::nil || q == node::nil) { continue; }
+
+      for (const T &w : other.words_of(q)) {
+        if (words_of(p).contains(w)) { res.push_back(w); }
+      }
+
+      const node &n_p = m_nodes[p];
+      const node &n_q = other.m_nodes[q];
+
+      // Case: Either node is a leaf
+      if (n_p.m_char == node::NIL || n_q.m_char == node::NIL) { continue; }
+
+      // Case: 'q' is behind
+      // -> Only the 'false' subtree of 'q' can be in common with 'p'.
+      if (m_char_comp(n_q.m_char, n_p.m_char)) {
+        stack.push_back({ p, n_q.m_children[false] });
+        continue;
+      }
+
+      // Case: 'q' is ahead
+      // -> Only the 'false' subtree of 'p' can be in common with 'q'.
+      if (m_char_comp(n_p.m_char, n_q.m_char)) {
+        stack.push_back({ n_p.m_children[false], q });
+        continue;
+      }
+
+      // Case: 'p' and 'q' match
+      stack.push_back({ n_p.m_children[false], n_q.m_children[false] });
+      stack.push_back({ n_p.m_children[true],  n_q.m_children[true] });
+    }
+    return res;
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Release the memory of all nodes and sets of words that have been
+  ///        removed with `erase(w)`.
+  ///
+  /// \details The nodes are moved into a new arena in depth-first order, i.e.
+  ///          the 'true' child of each node is placed immediately after it.
+  ///
+  /// \warning Requires \f$O(N)\f$ time.
+  //////////////////////////////////////////////////////////////////////////////
+  void
+  shrink_to_fit()
+  {
+    anatree_internal::cow_array<node> nodes(1);
+    nodes.reserve(concrete_tree_size() + 1u);
+
+    anatree_internal::cow_array<Set> word_sets(1);
+    word_sets.reserve(m_word_sets.size() - m_free_word_sets.size());
+
+    // Depth-first traversal with an explicit stack of the old node and where
+    // the new one is linked in.
+    struct frame
+    {
+      node_ptr p;
+      node_ptr parent;
+      bool side;
+    };
+
+    std::vector<frame> stack;
+    if (m_root != node::nil) {
+      stack.push_back({ m_root, node::null, false });
+    }
+
+    node_ptr root = node::nil;
+    while (!stack.empty()) {
+      const frame f = stack.back();
+      stack.pop_back();
+
+      const node_ptr np = nodes.size();
+      nodes.push_back(m_nodes[f.p]);
+      if (f.parent == node::null) {
+        root = np;
+      } else {
+        nodes.mut(f.parent).m_children[f.side] = np;
+      }
+
+      if (nodes[np].m_words != node::no_words) {
+        const node_ptr ws = m_nodes[f.p].m_words;
+        nodes.mut(np).m_words = word_sets.size();
+
+        // Case: Set of words is on a page of this tree
+        // -> Move it out.
+        //
+        // Case: Set of words is (possibly) shared with a copy
+        // -> Copy only it, rather than its entire page via `mut(...)`.
+        if (m_word_sets.owns(ws)) {
+          word_sets.push_back(std::move(m_word_sets.mut(ws)));
+        } else {
+          word_sets.push_back(m_word_sets[ws]);
+        }
+      }
+
+      // Push 'false' child first, such that the 'true' child is placed next.
+      if (m_nodes[f.p].m_children[false] != node::nil) {
+        stack.push_back({ m_nodes[f.p].m_children[false], np, false });
+      }
+      if (m_nodes[f.p].m_children[true] != node::nil) {
+        stack.push_back({ m_nodes[f.p].m_children[true], np, true });
+      }
+    }
+
+    m_nodes = std::move(nodes);
+    m_word_sets = std::move(word_sets);
+    m_free_nodes = std::vector<node_ptr>();
+    m_free_word_sets = std::vector<node_ptr>();
+    m_root = root;
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Obtain all words in the Anatree, excluding words that are a
+  ///        subanagram of another one returned.
+  //////////////////////////////////////////////////////////////////////////////
+  Set
+  keys() const
+  {
+    Set res;
+    keys(insert_into(res));
+    return res;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Call `f` on all words in the Anatree, excluding words that are a
+  ///        subanagram of another one provided.
+  ///
+  /// \details Each word is provided as soon as it is found and as an immutable
+  ///          reference into the tree, i.e. besides the tree itself only memory
+  ///          for one character mask per node and for the current path is
+  ///          used. If `f` returns a `bool`, then the search stops as soon as it
+  ///          returns `false`.
+  ///
+  ///          Only words at the leaves can be kept: the words on an internal
+  ///          node are a subanagram of the ones in its (non-empty) 'true'
+  ///          subtree. For each leaf, the tree itself is searched for a
+  ///          superanagram of its key (see `has_superanagram__key`).
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename F>
+  requires std::invocable<F, const T&>
+  void
+  keys(F &&f) const
+  {
+    const std::vector<char_mask> alphabets = subtree_alphabets();
+
+    // Buffers shared by all searches for a superanagram.
+    std::vector<char_mask> suffixes;
+    std::vector<superanagram_frame> search_stack;
+
+    // Depth-first traversal with an explicit stack of nodes and the length of
+    // the path to them. The characters on the 'true' edges of the current path
+    // are the key of the words at its end.
+    std::vector<std::pair<node_ptr, size_t>> stack;
+    std::vector<value_type> path;
+
+    stack.push_back({ m_root, 0u });
+
+    while (!stack.empty()) {
+      const auto [p, length] = stack.back();
+      stack.pop_back();
+
+      const node &n = m_nodes[p];
+      ANATREE_COUNT(nodes_visited, 1u);
+      path.resize(length);
+
+      // Case: Internal Node
+      // -> Look for leaves in both subtrees. The 'true' child is visited next,
+      //    i.e. before anything else changes the path.
+      if (n.m_char != node::NIL) {
+        ANATREE_COUNT(false_edges, 1u);
+        ANATREE_COUNT(true_edges, 1u);
+        path.push_back(n.m_char);
+        stack.push_back({ n.m_children[false], length });
+        stack.push_back({ n.m_children[true], length + 1u });
+        continue;
+      }
+
+      // Case: Leaf of Tree
+      // -> Provide a word, if any and if not a subanagram of another one.
+      if (words_of(p).size() == 0) { continue; }
+      if (has_superanagram__key(path, alphabets, suffixes, search_stack)) { continue; }
+
+      const T &w = *words_of(p).begin();
+      if constexpr (std::is_convertible_v<std::invoke_result_t<F&, const T&>, bool>) {
+        if (!f(w)) { return; }
+      } else {
+        f(w);
+      }
+    }
+  }
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief The characters within each subtree, indexed by its root.
+  //////////////////////////////////////////////////////////////////////////////
+  std::vector<char_mask>
+  subtree_alphabets() const
+  {
+    std::vector<char_mask> res(m_nodes.size(), 0u);
+
+    // Post-order traversal with an explicit stack of nodes (and whether their
+    // children already have been processed).
+    std::vector<std::pair<node_ptr, bool>> stack;
+    stack.push_back({ m_root, false });
+
+    while (!stack.empty()) {
+      const auto [p, expanded] = stack.back();
+      stack.pop_back();
+
+      const node &n = m_nodes[p];
+
+      // Case: Leaf of Tree
+      // -> No characters
+      if (n.m_char == node::NIL) { continue; }
+
+      // Case: Internal Node (first visit)
+      // -> Process subtrees first
+      if (!expanded) {
+        stack.push_back({ p, true });
+        stack.push_back({ n.m_children[false], false });
+        stack.push_back({ n.m_children[true], false });
+        continue;
+      }
+
+      // Case: Internal Node (second visit)
+      // -> Merge characters of both subtrees with this node's character
+      res[p] = char_bit(n.m_char) | res[n.m_children[false]] | res[n.m_children[true]];
+    }
+    return res;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Pending subtree of a superanagram search: a node together with
+  ///        the number of characters of the key matched on the path to it, and
+  ///        whether the path has an extra character.
+  //////////////////////////////////////////////////////////////////////////////
+  struct superanagram_frame
+  {
+    node_ptr p;
+    size_t matched;
+    bool extra;
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Whether there exists a word which has all letters in `key` and at
+  ///        least one more, i.e. `key` is a strict subanagram of it.
+  ///
+  /// \param key       The sorted key to search for.
+  ///
+  /// \param alphabets The characters within each subtree (see
+  ///                  `subtree_alphabets`).
+  ///
+  /// \param suffixes  Buffer for the characters of each suffix of `key`.
+  ///
+  /// \param stack     Buffer for the stack of the traversal.
+  ///
+  /// \details Since the path to each node is unique, so is the number of
+  ///          characters of `key` matched on it. Hence, each node is visited at
+  ///          most once. Subtrees with too few letters, or without some of the
+  ///          remaining ones, are skipped.
+  //////////////////////////////////////////////////////////////////////////////
+  bool
+  has_superanagram__key(const std::vector<value_type> &key,
+                        const std::vector<char_mask> &alphabets,
+                        std::vector<char_mask> &suffixes,
+                        std::vector<superanagram_frame> &stack) const
+  {
+    suffixes.assign(key.size() + 1u, 0u);
+    for (size_t i = key.size(); 0u < i; --i) {
+      suffixes[i-1u] = suffixes[i] | char_bit(key[i-1u]);
+    }
+
+    // Depth-first traversal with an explicit stack.
+    stack.clear();
+    stack.push_back({ m_root, 0u, false });
+
+    while (!stack.empty()) {
+      const superanagram_frame f = stack.back();
+      stack.pop_back();
+
+      const node &n = m_nodes[f.p];
+      ANATREE_COUNT(nodes_visited, 1u);
+
+      // Case: All characters of the key matched
+      // -> Succesful, if there are words with one more character.
+      if (f.matched == key.size()) {
+        const size_t words_below = n.m_subtree_words - words_of(f.p).size();
+        if (f.extra ? 0u < n.m_subtree_words : 0u < words_below) {
+          return true;
+        }
+        continue;
+      }
+
+      // Case: Too few letters in subtree or some are missing
+      // -> Abandon subtree
+      if (n.m_max_length < key.size() - f.matched
+          || (suffixes[f.matched] & ~alphabets[f.p]) != 0u) {
+        continue;
+      }
+
+      // Case: Next character of key can no longer be matched
+      // -> Abandon subtree
+      const value_type c = key[f.matched];
+      if (m_char_comp(c, n.m_char)) {
+        continue;
+      }
+
+      // Case: Next character of key
+      // -> Follow 'true' child and match it.
+      if (c == n.m_char) {
+        ANATREE_COUNT(true_edges, 1u);
+        stack.push_back({ n.m_children[true], f.matched + 1u, f.extra });
+        continue;
+      }
+
+      // Case: Character not in key
+      // -> Follow both children (trying the extra character first).
+      ANATREE_COUNT(false_edges, 1u);
+      ANATREE_COUNT(true_edges, 1u);
+      stack.push_back({ n.m_children[false], f.matched, f.extra });
+      stack.push_back({ n.m_children[true], f.matched, true });
+    }
+    return false;
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Obtain all words in the Anatree of a certain length, excluding
+  ///        words that are an anagram of another one returned.
+  ///
+  /// \param word_length The length of the desired words.
+  //////////////////////////////////////////////////////////////////////////////
+  Set
+  keys(const size_t word_length) const
+  {
+    Set res;
+    keys__iter(word_length, res);
+    return res;
+  }
+
+private:
+  void
+  keys__iter(const size_t word_length, Set &res) const
+  {
+    // Depth-first traversal with an explicit stack of nodes and the number of
+    // 'true' edges on the path to them.
+    std::vector<std::pair<node_ptr, size_t>> stack;
+    stack.push_back({ m_root, 0u });
+
+    while (!stack.empty()) {
+      const auto [p, true_edges] = stack.back();
+      stack.pop_back();
+
+      const node &n = m_nodes[p];
+      assert(true_edges <= word_length);
+
+      // Case: Found word of 'word_length'
+      // -> Search succesful (no need to keep on searching deeper)
+      if (word_length == true_edges) {
+        if (words_of(p).size() > 0) {
+          res.insert(*words_of(p).begin());
+        }
+        continue;
+      }
+
+      // Case: Tree stopped early
+      // -> Abandon subtree
+      if (n.m_char == node::NIL) {
+        continue;
+      }
+
+      // Case: Missing characters
+      // -> Merge from false and true subtrees
+      stack.push_back({ n.m_children[false], true_edges });
+      stack.push_back({ n.m_children[true], true_edges+1 });
+    }
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Whether there exists an anagrams of 'w'.
+  ///
+  /// \details An anagram is a word that can be created from (all) the letters
+  ///          of 'w'.
+  //////////////////////////////////////////////////////////////////////////////
+  bool
+  has_anagram_of(const T &w) const
+  {
+    const node_ptr p = find_node(sorted_key(w));
+    return p != node::null && words_of(p).size() > 0;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Whether there exists an anagrams of 'w'.
+  //////////////////////////////////////////////////////////////////////////////
+  template<std::same_as<view_type> V>
+  bool
+  has_anagram_of(const V w) const
+  {
+    const node_ptr p = find_node(sorted_key(w));
+    return p != node::null && words_of(p).size() > 0;
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Obtain all words that are anagrams of 'w'.
+  ///
+  /// \details An anagram is a word that can be created from (all) the letters
+  ///          of 'w'.
+  ///
+  /// \returns Immutable reference to the set of words stored in the tree
+  ///          (without copying it). This reference is invalidated by any
+  ///          subsequent change to the Anatree.
+  //////////////////////////////////////////////////////////////////////////////
+  const Set&
+  anagrams_of(const T &w) const
+  {
+    const node_ptr p = find_node(sorted_key(w));
+    return words_of(p != node::null ? p : node::nil);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Obtain all words that are anagrams of 'w'.
+  //////////////////////////////////////////////////////////////////////////////
+  template<std::same_as<view_type> V>
+  const Set&
+  anagrams_of(const V w) const
+  {
+    const node_ptr p = find_node(sorted_key(w));
+    return words_of(p != node::null ? p : node::nil);
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Obtain all words that are subanagrams of 'w'.
+  ///
+  /// \details A subanagram is a word that can be created from some (but not
+  ///          necessarily all) letters of 'w'.
+  //////////////////////////////////////////////////////////////////////////////
+  Set
+  subanagrams_of(const T &w) const
+  {
+    Set res;
+    subanagrams_of(w, insert_into(res));
+    return res;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Obtain all words that are subanagrams of 'w'.
+  //////////////////////////////////////////////////////////////////////////////
+  template<std::same_as<view_type> V>
+  Set
+  subanagrams_of(const V w) const
+  {
+    Set res;
+    subanagrams_of(w, insert_into(res));
+    return res;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Call `f` on each word that is a subanagram of 'w'.
+  ///
+  /// \details A subanagram is a word that can be created from some (but not
+  ///          necessarily all) letters of 'w'. Each word is provided exactly
+  ///          once and as an immutable reference into the tree, i.e. without
+  ///          copying it. If `f` returns a `bool`, then the search stops as
+  ///          soon as it returns `false`.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename F>
+  requires std::invocable<F, const T&>
+  void
+  subanagrams_of(const T &w, F &&f) const
+  {
+    const key_type key = subanagram_key(w);
+    subanagrams_of__iter(key, word_visitor(f));
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Call `f` on each word that is a subanagram of 'w'.
+  //////////////////////////////////////////////////////////////////////////////
+  template<std::same_as<view_type> V, typename F>
+  requires std::invocable<F, const T&>
+  void
+  subanagrams_of(const V w, F &&f) const
+  {
+    const key_type key = subanagram_key(w);
+    subanagrams_of__iter(key, word_visitor(f));
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Obtain all words of length `min_length` to `max_length` that are
+  ///        subanagrams of 'w' with up to `wildcards` additional letters.
+  ///
+  /// \details Each wildcard (e.g. a blank tile) stands for any single letter.
+  ///          Subtrees that cannot contain a word within the bounds are not
+  ///          visited, i.e. the cost depends on the number of words within the
+  ///          bounds rather than the number of subanagrams of 'w'.
+  //////////////////////////////////////////////////////////////////////////////
+  Set
+  subanagrams_of(const T &w,
+                 const size_t min_length,
+                 const size_t max_length,
+                 const size_t wildcards = 0u) const
+  {
+    Set res;
+    const key_type key = subanagram_key(w);
+    const auto f = insert_into(res);
+    subanagrams_of__iter(key, word_visitor(f), { min_length, max_length, wildcards });
+    return res;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Obtain all words of length `min_length` to `max_length` that are
+  ///        subanagrams of 'w' with up to `wildcards` additional letters.
+  //////////////////////////////////////////////////////////////////////////////
+  template<std::same_as<view_type> V>
+  Set
+  subanagrams_of(const V w,
+                 const size_t min_length,
+                 const size_t max_length,
+                 const size_t wildcards = 0u) const
+  {
+    Set res;
+    const key_type key = subanagram_key(w);
+    const auto f = insert_into(res);
+    subanagrams_of__iter(key, word_visitor(f), { min_length, max_length, wildcards });
+    return res;
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of words that are subanagrams of 'w'.
+  ///
+  /// \details Equivalent to `subanagrams_of(w).size()` but without copying any
+  ///          of the words.
+  //////////////////////////////////////////////////////////////////////////////
+  size_t
+  count_subanagrams_of(const T &w) const
+  {
+    const key_type key = subanagram_key(w);
+    return count_subanagrams_of__key(key);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of words that are subanagrams of 'w'.
+  //////////////////////////////////////////////////////////////////////////////
+  template<std::same_as<view_type> V>
+  size_t
+  count_subanagrams_of(const V w) const
+  {
+    const key_type key = subanagram_key(w);
+    return count_subanagrams_of__key(key);
+  }
+
+private:
+  size_t
+  count_subanagrams_of__key(const key_type &key) const
+  {
+    size_t res = 0u;
+    subanagrams_of__iter(key, [&res](const Set &words) {
+      res += words.size();
+      return true;
+    });
+    return res;
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Whether there exists a subanagram of 'w' with at least
+  ///        `min_length` letters.
+  ///
+  /// \details The search stops at the first such word. Subtrees without any
+  ///          word of sufficient length are skipped.
+  //////////////////////////////////////////////////////////////////////////////
+  bool
+  has_subanagram_of(const T &w, const size_t min_length = 0u) const
+  {
+    const key_type key = subanagram_key(w);
+    return has_subanagram_of__key(key, min_length);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Whether there exists a subanagram of 'w' with at least
+  ///        `min_length` letters.
+  //////////////////////////////////////////////////////////////////////////////
+  template<std::same_as<view_type> V>
+  bool
+  has_subanagram_of(const V w, const size_t min_length = 0u) const
+  {
+    const key_type key = subanagram_key(w);
+    return has_subanagram_of__key(key, min_length);
+  }
+
+private:
+  bool
+  has_subanagram_of__key(const key_type &key, const size_t min_length) const
+  {
+    bool res = false;
+    subanagrams_of__iter(key, [&res](const Set &) {
+      res = true;
+      return false;
+    }, { min_length });
+    return res;
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Obtain up to `k` (arbitrary) words that are subanagrams of 'w'.
+  ///
+  /// \details The search stops as soon as `k` words have been found.
+  //////////////////////////////////////////////////////////////////////////////
+  Set
+  any_subanagrams_of(const T &w, const size_t k) const
+  {
+    Set res;
+    if (k == 0u) { return res; }
+
+    subanagrams_of(w, [&res, k](const T &sw) {
+      ANATREE_COUNT(words_copied, 1u);
+      res.insert(sw);
+      return res.size() < k;
+    });
+    return res;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Obtain up to `k` (arbitrary) words that are subanagrams of 'w'.
+  //////////////////////////////////////////////////////////////////////////////
+  template<std::same_as<view_type> V>
+  Set
+  any_subanagrams_of(const V w, const size_t k) const
+  {
+    Set res;
+    if (k == 0u) { return res; }
+
+    subanagrams_of(w, [&res, k](const T &sw) {
+      ANATREE_COUNT(words_copied, 1u);
+      res.insert(sw);
+      return res.size() < k;
+    });
+    return res;
+  }
+
+private:
+  /// \brief Restrictions on the words reported by a subanagram search.
+  struct subanagram_bounds
+  {
+    size_t min_length = 0u;
+    size_t max_length = std::numeric_limits<size_t>::max();
+    size_t wildcards  = 0u;
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Function that copies each given word into `res`.
+  //////////////////////////////////////////////////////////////////////////////
+  static auto
+  insert_into(Set &res)
+  {
+    return [&res](const T &w) {
+      ANATREE_COUNT(words_copied, 1u);
+      res.insert(w);
+    };
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Lift a function on words to a visitor of a node's set of words
+  ///        for `subanagrams_of__iter`.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename F>
+  static auto
+  word_visitor(F &f)
+  {
+    return [&f](const Set &words) -> bool {
+      for (const T &w : words) {
+        if constexpr (std::is_convertible_v<std::invoke_result_t<F&, const T&>, bool>) {
+          if (!f(w)) { return false; }
+        } else {
+          f(w);
+        }
+      }
+      return true;
+    };
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Pending subtree of a subanagram search: the 'true' child at some
+  ///        fork together with the position within the key, the number of
+  ///        'true' edges (i.e. the length of the word) and the unused wildcards.
+  //////////////////////////////////////////////////////////////////////////////
+  struct subanagram_frame
+  {
+    node_ptr p;
+    key_iterator curr;
+    size_t true_edges;
+    size_t wildcards;
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Call `visit` on the set of words of each node that holds
+  ///        subanagrams of `key` within the bounds `b`. The search stops as soon
+  ///        as `visit` returns `false`.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename Visit>
+  void
+  subanagrams_of__iter(const key_type &key, Visit &&visit, const subanagram_bounds b = {}) const
+  {
+    std::vector<subanagram_frame> stack;
+    stack.reserve(key.size() + b.wildcards + 1u);
+    stack.push_back({ m_root, key.begin(), 0u, b.wildcards });
+
+    subanagrams_of__iter(key, visit, b, stack);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Depth-first traversal of all subtrees on the `stack` (and the ones
+  ///        pushed to it along the way).
+  ///
+  /// \returns Whether the search ran to completion, i.e. `visit` never returned
+  ///          `false`.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename Visit>
+  bool
+  subanagrams_of__iter(const key_type &key,
+                       Visit &visit,
+                       const subanagram_bounds b,
+                       std::vector<subanagram_frame> &stack) const
+  {
+    while (!stack.empty()) {
+      const subanagram_frame f = stack.back();
+      stack.pop_back();
+
+      if (!subanagrams_of__chain(key, f, visit, b, stack)) { return false; }
+    }
+    return true;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Follow the chain of 'false' children from the subtree `f`, pushing
+  ///        its forks to the `stack`.
+  ///
+  /// \returns Whether `visit` never returned `false`.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename Visit>
+  bool
+  subanagrams_of__chain(const key_type &key,
+                        subanagram_frame f,
+                        Visit &visit,
+                        const subanagram_bounds b,
+                        std::vector<subanagram_frame> &stack) const
+  {
+    while (true) {
+      if (subanagrams_of__abandon(key, f, b)) { return true; }
+
+      if (b.min_length <= f.true_edges && words_of(f.p).size() > 0) {
+        if (!visit(words_of(f.p))) { return false; }
+      }
+
+      if (!subanagrams_of__step(key, f, b, stack)) { return true; }
+    }
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Whether no word within the bounds `b` can be reached from `f`.
+  //////////////////////////////////////////////////////////////////////////////
+  bool
+  subanagrams_of__abandon(const key_type &key,
+                          const subanagram_frame &f,
+                          const subanagram_bounds b) const
+  {
+    ANATREE_COUNT(nodes_visited, 1u);
+
+    // Case: Too few letters left or too short words below to reach
+    //       'min_length'
+    // -> Abandon subtree
+    const size_t letters_left = static_cast<size_t>(key.end() - f.curr) + f.wildcards;
+    return f.true_edges + std::min(letters_left, m_nodes[f.p].m_max_length) < b.min_length;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Move `f` from its node to the node's 'false' child, pushing the
+  ///        'true' child to the `stack` (if it can hold subanagrams).
+  ///
+  /// \returns Whether the 'false' child can hold subanagrams, i.e. whether the
+  ///          chain continues.
+  //////////////////////////////////////////////////////////////////////////////
+  bool
+  subanagrams_of__step(const key_type &key,
+                       subanagram_frame &f,
+                       const subanagram_bounds b,
+                       std::vector<subanagram_frame> &stack) const
+  {
+    const node &n = m_nodes[f.p];
+
+    // Case: Anatree is done
+    // -> Stop
+    if (n.m_char == node::NIL) {
+      return false;
+    }
+
+    // Case: Words have reached 'max_length'
+    // -> Stop (words are only reachable via another 'true' edge)
+    if (f.true_edges == b.max_length) {
+      return false;
+    }
+
+    // Case: Iterator behind
+    // -> Skip missing characters
+    while (f.curr != key.end() && m_char_comp(*f.curr, n.m_char)) { ++f.curr; }
+
+    // Case: Iterator and node matches
+    // -> Follow both children (postponing the 'true' child)
+    if (f.curr != key.end() && !m_char_comp(n.m_char, *f.curr)) {
+      ++f.curr;
+      ANATREE_COUNT(true_edges, 1u);
+      stack.push_back({ n.m_children[true], f.curr, f.true_edges+1, f.wildcards });
+    }
+    // Case: Iterator ahead (or done) but some wildcards are left
+    // -> Follow both children (using a wildcard for the 'true' child)
+    else if (0u < f.wildcards) {
+      ANATREE_COUNT(true_edges, 1u);
+      stack.push_back({ n.m_children[true], f.curr, f.true_edges+1, f.wildcards-1 });
+    }
+    // Case: Iterator done
+    // -> Stop
+    else if (f.curr == key.end()) {
+      return false;
+    }
+
+    // Case: Iterator ahead (or matches)
+    // -> Follow 'false' child
+    ANATREE_COUNT(false_edges, 1u);
+    f.p = n.m_children[false];
+    return true;
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Lazy range of all subanagrams of a word, see `subanagrams_range`.
+  ///
+  /// \details The search is suspended whenever it has found a node with words
+  ///          and is only resumed when all of them have been consumed. Hence,
+  ///          only as much of the tree is traversed as is needed for the words
+  ///          actually read. This is a single-pass (input) range whose
+  ///          iterators refer to the range itself. The range is invalidated by
+  ///          any change to the Anatree.
+  //////////////////////////////////////////////////////////////////////////////
+  class subanagram_range
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Input iterator over the remaining words of the range.
+    ////////////////////////////////////////////////////////////////////////////
+    class iterator
+    {
+    public:
+      using iterator_concept = std::input_iterator_tag;
+      using value_type       = T;
+      using difference_type  = std::ptrdiff_t;
+      using reference        = const T&;
+      using pointer          = const T*;
+
+    private:
+      subanagram_range *m_range = nullptr;
+
+    public:
+      iterator() = default;
+
+      explicit
+      iterator(subanagram_range *range)
+        : m_range(range)
+      { }
+
+    public:
+      reference operator* () const { return *m_range->m_word; }
+      pointer   operator->() const { return &*m_range->m_word; }
+
+      iterator&
+      operator++ ()
+      {
+        m_range->next_word();
+        return *this;
+      }
+
+      void
+      operator++ (int)
+      {
+        ++*this;
+      }
+
+      friend bool
+      operator== (const iterator &it, std::default_sentinel_t)
+      {
+        return it.done();
+      }
+
+    private:
+      bool
+      done() const
+      {
+        return m_range->m_words == nullptr;
+      }
+    };
+
+  private:
+    friend class anatree;
+
+    const anatree *m_tree;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Key of the query. It is kept on the heap, since the frames refer
+    ///        to its characters and the range may be moved.
+    ////////////////////////////////////////////////////////////////////////////
+    std::unique_ptr<const key_type> m_key;
+
+    subanagram_bounds m_bounds;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Pending 'true' subtrees of the search.
+    ////////////////////////////////////////////////////////////////////////////
+    std::vector<subanagram_frame> m_stack;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Current position within a chain of 'false' children (if
+    ///        `m_in_chain`).
+    ////////////////////////////////////////////////////////////////////////////
+    subanagram_frame m_chain;
+    bool m_in_chain = false;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Set of the current word (nullptr once the search is done) and
+    ///        the current word within it.
+    ////////////////////////////////////////////////////////////////////////////
+    const Set *m_words = nullptr;
+    typename Set::const_iterator m_word;
+
+    bool m_started = false;
+
+  private:
+    subanagram_range(const anatree &tree, key_type *key, const subanagram_bounds b)
+      : m_tree(&tree), m_key(key), m_bounds(b)
+    {
+      m_stack.push_back({ tree.m_root, m_key->begin(), 0u, b.wildcards });
+    }
+
+  public:
+    subanagram_range(subanagram_range&&) = default;
+    subanagram_range& operator=(subanagram_range&&) = default;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Iterator to the first word, which is only searched for now.
+    ////////////////////////////////////////////////////////////////////////////
+    iterator
+    begin()
+    {
+      if (!m_started) {
+        m_started = true;
+        next_words();
+      }
+      return iterator(this);
+    }
+
+    std::default_sentinel_t
+    end() const
+    {
+      return std::default_sentinel;
+    }
+
+  private:
+    void
+    next_word()
+    {
+      if (++m_word == m_words->end()) { next_words(); }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Resume the search until the next node with words (within the
+    ///        bounds) has been found.
+    ////////////////////////////////////////////////////////////////////////////
+    void
+    next_words()
+    {
+      const anatree &tree = *m_tree;
+      const key_type &key = *m_key;
+
+      // Work on a local copy of the current frame, such that it can be kept in
+      // registers, and only store it when the search is suspended.
+      subanagram_frame f = m_chain;
+      bool in_chain = m_in_chain;
+
+      while (true) {
+        if (!in_chain) {
+          // Case: No subtrees left
+          // -> Done
+          if (m_stack.empty()) {
+            m_in_chain = false;
+            m_words = nullptr;
+            return;
+          }
+          f = m_stack.back();
+          m_stack.pop_back();
+        }
+
+        if (tree.subanagrams_of__abandon(key, f, m_bounds)) {
+          in_chain = false;
+          continue;
+        }
+
+        const Set &words = tree.words_of(f.p);
+        const bool visit = m_bounds.min_length <= f.true_edges && words.size() > 0;
+
+        in_chain = tree.subanagrams_of__step(key, f, m_bounds, m_stack);
+
+        if (visit) {
+          m_chain = f;
+          m_in_chain = in_chain;
+          m_words = &words;
+          m_word  = words.begin();
+          return;
+        }
+      }
+    }
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Lazy range of all words that are subanagrams of 'w'.
+  ///
+  /// \details Same words as `subanagrams_of(w)`, but these are neither copied
+  ///          nor searched for until they are read. For example, taking only
+  ///          the first 50 words only traverses the tree up to the 50th word.
+  //////////////////////////////////////////////////////////////////////////////
+  subanagram_range
+  subanagrams_range(const T &w) const
+  {
+    return subanagram_range(*this, new key_type(subanagram_key(w)), {});
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Lazy range of all words that are subanagrams of 'w'.
+  //////////////////////////////////////////////////////////////////////////////
+  template<std::same_as<view_type> V>
+  subanagram_range
+  subanagrams_range(const V w) const
+  {
+    return subanagram_range(*this, new key_type(subanagram_key(w)), {});
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Lazy range of all words of length `min_length` to `max_length`
+  ///        that are subanagrams of 'w' with up to `wildcards` additional
+  ///        letters.
+  //////////////////////////////////////////////////////////////////////////////
+  subanagram_range
+  subanagrams_range(const T &w,
+                    const size_t min_length,
+                    const size_t max_length,
+                    const size_t wildcards = 0u) const
+  {
+    return subanagram_range(*this, new key_type(subanagram_key(w)),
+                            { min_length, max_length, wildcards });
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Lazy range of all words of length `min_length` to `max_length`
+  ///        that are subanagrams of 'w' with up to `wildcards` additional
+  ///        letters.
+  //////////////////////////////////////////////////////////////////////////////
+  template<std::same_as<view_type> V>
+  subanagram_range
+  subanagrams_range(const V w,
+                    const size_t min_length,
+                    const size_t max_length,
+                    const size_t wildcards = 0u) const
+  {
+    return subanagram_range(*this, new key_type(subanagram_key(w)),
+                            { min_length, max_length, wildcards });
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Subtrees with fewer words than this are not split any further
+  ///        between the threads of `parallel_subanagrams_of`.
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr size_t parallel_cutoff = 1024u;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Obtain all words that are subanagrams of 'w' with up to `threads`
+  ///        threads (by default, one per hardware thread).
+  ///
+  /// \details The search is split at the forks closest to the root into tasks
+  ///          for all subtrees with at least `parallel_cutoff` words. Each
+  ///          thread takes the next task (largest first) whenever it is done
+  ///          with the previous one and collects its words into its own set.
+  ///          These are merged at the end.
+  ///
+  /// \remark Other threads may read from, but must not modify, the Anatree
+  ///         during the search.
+  //////////////////////////////////////////////////////////////////////////////
+  Set
+  parallel_subanagrams_of(const T &w, const size_t threads = 0u) const
+  {
+    const key_type key = subanagram_key(w);
+    return parallel_subanagrams_of__key(key, threads);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Obtain all words that are subanagrams of 'w' with up to `threads`
+  ///        threads (by default, one per hardware thread).
+  //////////////////////////////////////////////////////////////////////////////
+  template<std::same_as<view_type> V>
+  Set
+  parallel_subanagrams_of(const V w, const size_t threads = 0u) const
+  {
+    const key_type key = subanagram_key(w);
+    return parallel_subanagrams_of__key(key, threads);
+  }
+
+private:
+  Set
+  parallel_subanagrams_of__key(const key_type &key, size_t threads) const
+  {
+    if (threads == 0u) {
+      threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    Set res;
+    const auto insert_into_res = insert_into(res);
+    auto visit_res = word_visitor(insert_into_res);
+
+    const subanagram_bounds b = {};
+
+    // Split the largest subtree until there are enough tasks to balance the
+    // work between all threads (or all subtrees are small). Words encountered
+    // along the way are added to the result immediately.
+    const size_t max_tasks = 8u * threads;
+
+    std::vector<subanagram_frame> tasks;
+    tasks.push_back({ m_root, key.begin(), 0u, b.wildcards });
+
+    const auto subtree_lt = [this](const subanagram_frame &a, const subanagram_frame &b) {
+      return m_nodes[a.p].m_subtree_words < m_nodes[b.p].m_subtree_words;
+    };
+
+    while (1u < threads && !tasks.empty() && tasks.size() < max_tasks) {
+      const auto largest = std::max_element(tasks.begin(), tasks.end(), subtree_lt);
+      if (m_nodes[largest->p].m_subtree_words < parallel_cutoff) { break; }
+
+      const subanagram_frame f = *largest;
+      *largest = tasks.back();
+      tasks.pop_back();
+
+      subanagrams_of__chain(key, f, visit_res, b, tasks);
+    }
+
+    // Case: Not worth splitting
+    // -> Finish the search on this thread
+    if (threads == 1u || tasks.size() <= 1u) {
+      subanagrams_of__iter(key, visit_res, b, tasks);
+      return res;
+    }
+
+    // Case: Several tasks
+    // -> Process them in parallel, largest first.
+    std::sort(tasks.begin(), tasks.end(),
+              [&subtree_lt](const subanagram_frame &a, const subanagram_frame &b) {
+                return subtree_lt(b, a);
+              });
+
+    std::atomic<size_t> next_task = 0u;
+
+    const auto worker = [&]() {
+      Set local_res;
+      const auto insert_into_local = insert_into(local_res);
+      auto visit_local = word_visitor(insert_into_local);
+
+      std::vector<subanagram_frame> stack;
+      for (size_t i = next_task++; i < tasks.size(); i = next_task++) {
+        stack.push_back(tasks[i]);
+        subanagrams_of__iter(key, visit_local, b, stack);
+      }
+      return local_res;
+    };
+
+    std::vector<std::future<Set>> futures;
+    for (size_t t = 1u; t < std::min(threads, tasks.size()); ++t) {
+      futures.push_back(std::async(std::launch::async, worker));
+    }
+
+    Set local_res = worker();
+    anatree_internal::merge_words(res, local_res);
+    for (auto &f : futures) {
+      Set other_res = f.get();
+      anatree_internal::merge_words(res, other_res);
+    }
+    return res;
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Whether the Anatree includes the word 'w'.
+  //////////////////////////////////////////////////////////////////////////////
+  bool
+  contains(const T &w) const
+  {
+    const node_ptr p = find_node(sorted_key(w));
+    return p != node::null && words_of(p).contains(w);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Whether the Anatree includes the word 'w'.
+  ///
+  /// \details A word of type `T` is only created from 'w', if its key is in the
+  ///          tree and `Set` does not support lookups of views (see
+  ///          `transparent_hash`).
+  //////////////////////////////////////////////////////////////////////////////
+  template<std::same_as<view_type> V>
+  bool
+  contains(const V w) const
+  {
+    const node_ptr p = find_node(sorted_key(w));
+    return p != node::null && contains_word(words_of(p), w);
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Batches with fewer words than this are not split any further
+  ///        between threads.
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr size_t batch_cutoff = 1024u;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief For each word in the given range, whether the Anatree includes it.
+  ///
+  /// \details All words are looked up together in a single traversal of the
+  ///          tree (see `anagrams_of_batch`).
+  ///
+  /// \param threads Number of threads to use (0 for one per hardware thread).
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename ForwardIt>
+  requires std::forward_iterator<ForwardIt>
+        && std::is_convertible<typename std::iterator_traits<ForwardIt>::value_type, T>::value
+  std::vector<bool>
+  contains_batch(ForwardIt begin, ForwardIt end, const size_t threads = 1u) const
+  {
+    const std::vector<node_ptr> ps = find_nodes(begin, end, threads);
+
+    std::vector<bool> res;
+    res.reserve(ps.size());
+    for (const node_ptr p : ps) {
+      const T &w = *(begin++);
+      res.push_back(p != node::null && words_of(p).contains(w));
+    }
+    return res;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief For each word in the given range, whether there exists an anagram
+  ///        of it.
+  ///
+  /// \details All words are looked up together in a single traversal of the
+  ///          tree (see `anagrams_of_batch`).
+  ///
+  /// \param threads Number of threads to use (0 for one per hardware thread).
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename ForwardIt>
+  requires std::forward_iterator<ForwardIt>
+        && std::is_convertible<typename std::iterator_traits<ForwardIt>::value_type, T>::value
+  std::vector<bool>
+  has_anagram_of_batch(ForwardIt begin, ForwardIt end, const size_t threads = 1u) const
+  {
+    const std::vector<node_ptr> ps = find_nodes(begin, end, threads);
+
+    std::vector<bool> res;
+    res.reserve(ps.size());
+    for (const node_ptr p : ps) {
+      res.push_back(p != node::null && words_of(p).size() > 0);
+    }
+    return res;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief For each word in the given range, obtain all words that are
+  ///        anagrams of it.
+  ///
+  /// \details The keys of all words are sorted such that they can be looked up
+  ///          together in a single traversal of the tree. At each node the
+  ///          batch is split into the keys that end there, the ones that
+  ///          continue in its 'true' and in its 'false' subtree. Hence, each
+  ///          node is visited at most once.
+  ///
+  /// \param threads Number of threads to use (0 for one per hardware thread).
+  ///                Each thread traverses the tree for a consecutive part of
+  ///                the sorted keys.
+  ///
+  /// \returns Immutable references to the sets of words in the same order as
+  ///          the given words. These are invalidated by any subsequent change
+  ///          to the Anatree.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename ForwardIt>
+  requires std::forward_iterator<ForwardIt>
+        && std::is_convertible<typename std::iterator_traits<ForwardIt>::value_type, T>::value
+  std::vector<std::reference_wrapper<const Set>>
+  anagrams_of_batch(ForwardIt begin, ForwardIt end, const size_t threads = 1u) const
+  {
+    const std::vector<node_ptr> ps = find_nodes(begin, end, threads);
+
+    std::vector<std::reference_wrapper<const Set>> res;
+    res.reserve(ps.size());
+    for (const node_ptr p : ps) {
+      res.push_back(std::cref(words_of(p != node::null ? p : node::nil)));
+    }
+    return res;
+  }
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Traverses the anatree in search of the nodes corresponding to the
+  ///        keys of all given words.
+  ///
+  /// \returns Index of the node for each word (in the same order). If there is
+  ///          none, then it is `node::null`.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename ForwardIt>
+  std::vector<node_ptr>
+  find_nodes(ForwardIt begin, ForwardIt end, size_t threads) const
+  {
+    std::vector<T> keys;
+    for (; begin != end; ++begin) {
+      keys.push_back(sorted_word(*begin));
+    }
+
+    std::vector<size_t> order(keys.size());
+    for (size_t i = 0u; i < order.size(); ++i) { order[i] = i; }
+
+    const auto key_lt = [this, &keys](const size_t a, const size_t b) {
+      return std::lexicographical_compare(keys[a].begin(), keys[a].end(),
+                                          keys[b].begin(), keys[b].end(),
+                                          m_char_comp);
+    };
+    std::sort(order.begin(), order.end(), key_lt);
+
+    std::vector<node_ptr> res(keys.size(), node::null);
+
+    if (threads == 0u) {
+      threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::max<size_t>(1u, std::min(threads, keys.size() / batch_cutoff));
+
+    // Case: Single thread
+    // -> Look up all keys on this thread
+    if (threads == 1u) {
+      find_nodes__iter(keys, order, 0u, keys.size(), res);
+      return res;
+    }
+
+    // Case: Several threads
+    // -> Split the sorted keys into consecutive parts of (almost) equal size.
+    //    Each part writes to disjoint entries of 'res'.
+    std::vector<std::future<void>> futures;
+    for (size_t t = 0u; t < threads; ++t) {
+      const size_t part_begin = (keys.size() * t) / threads;
+      const size_t part_end   = (keys.size() * (t+1u)) / threads;
+
+      futures.push_back(std::async(std::launch::async, [&, part_begin, part_end]() {
+        find_nodes__iter(keys, order, part_begin, part_end, res);
+      }));
+    }
+    for (auto &f : futures) { f.get(); }
+
+    return res;
+  }
+
+  void
+  find_nodes__iter(const std::vector<T> &keys,
+                   const std::vector<size_t> &order,
+                   const size_t begin,
+                   const size_t end,
+                   std::vector<node_ptr> &res) const
+  {
+    // Depth-first traversal with an explicit stack of nodes, the range of
+    // (sorted) keys that are looked up in its subtree, and the number of
+    // characters of these keys that have already been consumed.
+    struct frame
+    {
+      node_ptr p;
+      size_t begin;
+      size_t end;
+      size_t depth;
+    };
+
+    std::vector<frame> stack;
+    if (begin < end) {
+      stack.push_back({ m_root, begin, end, 0u });
+    }
+
+    while (!stack.empty()) {
+      const frame f = stack.back();
+      stack.pop_back();
+
+      const node &n = m_nodes[f.p];
+      ANATREE_COUNT(nodes_visited, 1u);
+
+      // Case: Iterator done
+      // -> Found node for word (these are sorted before all longer keys)
+      size_t i = f.begin;
+      for (; i < f.end && keys[order[i]].size() == f.depth; ++i) {
+        res[order[i]] = f.p;
+      }
+
+      // Case: Tree is done
+      // -> No words with all letters exist for the remaining keys
+      if (i == f.end || n.m_char == node::NIL) { continue; }
+
+      // Case: Iterator behind
+      // -> No words with all letters exist for these keys
+      while (i < f.end && m_char_comp(keys[order[i]][f.depth], n.m_char)) { ++i; }
+
+      // Case: Iterator and node matches
+      // -> Follow 'true' child with the keys up to 'j'
+      size_t j = i;
+      while (j < f.end && !m_char_comp(n.m_char, keys[order[j]][f.depth])) { ++j; }
+
+      // Case: Iterator ahead
+      // -> Follow 'false' child with the remaining keys
+      if (j < f.end) {
+        ANATREE_COUNT(false_edges, 1u);
+        stack.push_back({ n.m_children[false], j, f.end, f.depth });
+      }
+      if (i < j) {
+        ANATREE_COUNT(true_edges, 1u);
+        stack.push_back({ n.m_children[true], i, j, f.depth+1u });
+      }
+    }
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of stored words.
+  //////////////////////////////////////////////////////////////////////////////
+  size_t
+  size() const
+  {
+    return m_size;
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Whether the Anatree is empty.
+  //////////////////////////////////////////////////////////////////////////////
+  bool
+  empty() const
+  {
+    return size() == 0u;
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Identifier of the current version of the words in the Anatree.
+  ///
+  /// \details Every change to the words (e.g. `insert`, `erase`, `clear`, and
+  ///          `merge`) assigns a new epoch that is distinct from the epochs of
+  ///          all Anatrees within this process. A copy shares the epoch of the
+  ///          original until either of them is changed, while all new (empty)
+  ///          Anatrees start at epoch 0. Hence, the result of a query remains
+  ///          valid for as long as the epoch is unchanged (see
+  ///          `query_cache<...>`).
+  //////////////////////////////////////////////////////////////////////////////
+  uint64_t
+  epoch() const
+  {
+    return m_epoch;
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Forward iterator over all words of the Anatree in the order of
+  ///        their keys (and in the order of `Set` among anagrams).
+  ///
+  /// \details The tree is traversed depth-first with an explicit stack of the
+  ///          pending subtrees: the words of a node come before the ones in
+  ///          its 'true' subtree which in turn come before the ones in its
+  ///          'false' subtree. Iterators are invalidated by any change to the
+  ///          Anatree.
+  //////////////////////////////////////////////////////////////////////////////
+  class const_iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = T;
+    using difference_type   = std::ptrdiff_t;
+    using reference         = const T&;
+    using pointer           = const T*;
+
+  private:
+    friend class anatree;
+
+    const anatree *m_tree = nullptr;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Subtrees yet to be visited (the next one on top).
+    ////////////////////////////////////////////////////////////////////////////
+    std::vector<node_ptr> m_stack;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Node of the current word (`node::null` at the end) and the
+    ///        current word within its set of words.
+    ////////////////////////////////////////////////////////////////////////////
+    node_ptr m_p = node::null;
+    typename Set::const_iterator m_word;
+
+    explicit
+    const_iterator(const anatree *tree)
+      : m_tree(tree)
+    {
+      m_stack.push_back(tree->m_root);
+      next_node();
+    }
+
+  public:
+    const_iterator() = default;
+
+  public:
+    reference operator* () const { return *m_word; }
+    pointer   operator->() const { return &*m_word; }
+
+    const_iterator&
+    operator++ ()
+    {
+      if (++m_word == m_tree->words_of(m_p).end()) { next_node(); }
+      return *this;
+    }
+
+    const_iterator
+    operator++ (int)
+    {
+      const_iterator res = *this;
+      ++*this;
+      return res;
+    }
+
+    friend bool
+    operator== (const const_iterator &a, const const_iterator &b)
+    {
+      return a.m_p == b.m_p && (a.m_p == node::null || a.m_word == b.m_word);
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Move to the first word of the next node with words.
+    ////////////////////////////////////////////////////////////////////////////
+    void
+    next_node()
+    {
+      while (!m_stack.empty()) {
+        const node_ptr p = m_stack.back();
+        m_stack.pop_back();
+
+        const node &n = m_tree->m_nodes[p];
+        ANATREE_COUNT(nodes_visited, 1u);
+
+        // Push the 'false' child first, such that the 'true' child is next.
+        if (n.m_children[false] != node::nil) { m_stack.push_back(n.m_children[false]); }
+        if (n.m_children[true]  != node::nil) { m_stack.push_back(n.m_children[true]); }
+
+        const Set &words = m_tree->words_of(p);
+        if (!words.empty()) {
+          m_p    = p;
+          m_word = words.begin();
+          return;
+        }
+      }
+      m_p = node::null;
+    }
+  };
+
+  using iterator = const_iterator;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Iterator to the first word (in the order of their keys).
+  //////////////////////////////////////////////////////////////////////////////
+  const_iterator
+  begin() const
+  {
+    return const_iterator(this);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Iterator past the last word.
+  //////////////////////////////////////////////////////////////////////////////
+  const_iterator
+  end() const
+  {
+    return const_iterator();
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of nodes within the tree (including all NIL leaves).
+  //////////////////////////////////////////////////////////////////////////////
+  size_t
+  tree_size() const
+  {
+    return m_tree_size;
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of nodes within the tree that are materialized in memory.
+  ///
+  /// \details Unlike `tree_size()`, this excludes all empty NIL leaves, since
+  ///          these are represented by a single shared sentinel.
+  //////////////////////////////////////////////////////////////////////////////
+  size_t
+  concrete_tree_size() const
+  {
+    return m_nodes.size() - 1u - m_free_nodes.size();
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Memory used by the nodes and the sets of words.
+  ///
+  /// \details The bytes of each `Set` are estimated from its number of buckets
+  ///          (if any) and elements, and the capacity of each word.
+  ///
+  /// \warning Requires \f$O(N)\f$ time.
+  //////////////////////////////////////////////////////////////////////////////
+  memory_stats
+  memory_usage() const
+  {
+    memory_stats res;
+    res.node_bytes = m_nodes.capacity() * sizeof(node);
+    res.free_nodes = m_free_nodes.size();
+
+    for (node_ptr p = node::nil + 1u; p < m_nodes.size(); ++p) {
+      if (m_nodes[p].m_char != node::NIL) { res.internal_nodes++; }
+    }
+    res.nil_nodes = concrete_tree_size() - res.internal_nodes;
+
+    res.shared_pages = m_nodes.shared_pages() + m_word_sets.shared_pages();
+
+    res.set_bytes = m_word_sets.capacity() * sizeof(Set);
+    for (node_ptr ws = node::no_words; ws < m_word_sets.size(); ++ws) {
+      const Set &words = m_word_sets[ws];
+      if (words.size() > 0u) { res.word_sets++; }
+
+      if constexpr (requires { words.bucket_count(); }) {
+        // Bucket array and, per element, a pointer to the next one and the
+        // cached hash value.
+        res.set_bytes += words.bucket_count() * sizeof(void*)
+                       + words.size() * (sizeof(void*) + sizeof(size_t));
+      }
+      for (const T &w : words) {
+        res.set_bytes += sizeof(T);
+        if constexpr (requires { w.capacity(); }) {
+          // Words longer than the (small-string) buffer are on the heap.
+          if (T().capacity() < w.capacity()) {
+            res.set_bytes += (w.capacity() + 1u) * sizeof(value_type);
+          }
+        }
+      }
+    }
+    return res;
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Whether queries are instrumented, i.e. `ANATREE_STATS` is defined.
+  //////////////////////////////////////////////////////////////////////////////
+#ifdef ANATREE_STATS
+  static constexpr bool has_query_stats = true;
+#else
+  static constexpr bool has_query_stats = false;
+#endif
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Work done by all queries on the current thread since the last call
+  ///        to `reset_query_stats()`.
+  ///
+  /// \details Work done by other threads, e.g. the workers of
+  ///          `parallel_subanagrams_of`, is not included. If `has_query_stats`
+  ///          is false, then all counters are zero.
+  //////////////////////////////////////////////////////////////////////////////
+  static traversal_stats
+  query_stats()
+  {
+#ifdef ANATREE_STATS
+    return anatree_internal::thread_stats;
+#else
+    return traversal_stats();
+#endif
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Reset the counters of `query_stats()` on the current thread.
+  //////////////////////////////////////////////////////////////////////////////
+  static void
+  reset_query_stats()
+  {
+#ifdef ANATREE_STATS
+    anatree_internal::thread_stats = traversal_stats();
+#endif
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Create an immutable copy of this Anatree with a flat and compact
+  ///        memory layout.
+  ///
+  /// \see frozen_anatree
+  //////////////////////////////////////////////////////////////////////////////
+  frozen_anatree<T, Compare, Set>
+  freeze() const
+  {
+    return frozen_anatree<T, Compare, Set>(*this);
+  }
+
+private:
+  template<typename T_, typename Compare_, typename Set_>
+  friend class frozen_anatree;
+
+  template<typename T_, typename Compare_, typename Set_>
+  friend class query_cache;
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Creates a copy of the word 'w' with its characters sorted.
+  //////////////////////////////////////////////////////////////////////////////
+  T sorted_word(const T &w) const
+  {
+    ANATREE_COUNT(sorted_keys, 1u);
+    T ret(w);
+    anatree_internal::sort_chars(ret.begin(), ret.end(), m_char_comp);
+    return ret;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Creates the key of the word 'w', i.e. its characters sorted,
+  ///        without allocating memory for short words.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename W>
+  key_type sorted_key(const W &w) const
+  {
+    ANATREE_COUNT(sorted_keys, 1u);
+    return key_type(w.begin(), w.end(), m_char_comp);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Creates the key of the word 'w' for a subanagram search, i.e. its
+  ///        characters sorted but without the ones that are in no stored word.
+  ///
+  /// \details Such characters can never be matched. Dropping them up-front
+  ///          saves skipping them again and again throughout the traversal.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename W>
+  key_type subanagram_key(const W &w) const
+  {
+    ANATREE_COUNT(sorted_keys, 1u);
+    const char_mask alphabet = m_alphabet;
+    return key_type(w.begin(), w.end(), m_char_comp, [alphabet](const value_type c) {
+      return (char_bit(c) & alphabet) != 0u;
+    });
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Traverses the anatree in search of the node corresponding to the
+  ///        given key.
+  ///
+  /// \returns Index of the node in the tree. If there is none, then it returns
+  ///          `node::null`.
+  /////////////////////////////////////////////////////////////////////////////
+  node_ptr find_node(const key_type &key) const
+  {
+    // Case: Some character is in no stored word
+    // -> No words with all letters exist, return Ø .
+    if ((char_mask_of(key) & ~m_alphabet) != 0u) {
+      return node::null;
+    }
+
+    node_ptr p = m_root;
+
+    for (key_iterator curr = key.begin(); curr != key.end();) {
+      const node &n = m_nodes[p];
+      ANATREE_COUNT(nodes_visited, 1u);
+
+      // Case: Iterator behind or tree is done
+      // -> No words with all letters exist, return Ø .
+      if (m_char_comp(*curr, n.m_char) || n.m_char == node::NIL) {
+        return node::null;
+      }
+
+      // Case: Iterator ahead
+      // -> Follow 'false' child
+      if (m_char_comp(n.m_char, *curr)) {
+        ANATREE_COUNT(false_edges, 1u);
+        p = n.m_children[false];
+        continue;
+      }
+
+      // Case: Iterator and node matches
+      // -> Follow 'true' child
+      ANATREE_COUNT(true_edges, 1u);
+      p = n.m_children[true];
+      ++curr;
+    }
+
+    // Case: Iterator is done
+    return p;
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Immutable version of `anatree<...>`, built from a (mutable) Anatree
+///        and laid out for read-only queries.
+///
+/// \details Structurally equal subtrees, e.g. all the tails of keys that end
+///          in the same characters, are shared. Hence, the nodes form a DAG
+///          rather than a tree (similar to the node sharing in BDDs). Words
+///          are not stored in the nodes but are numbered by the order in which
+///          a depth-first traversal would find them. All words are packed into
+///          a single array of characters.
+///
+///          Repetitions of a character are run-length encoded, i.e. a node
+///          can stand for several copies of its character. This shortens the
+///          paths of repetitive keys, e.g. DNA k-mers or multisets of dice.
+///
+/// \tparam T       Type for words, i.e. lists of elemnts.
+///
+/// \tparam Compare Ordering of the symbols within each word.
+///
+/// \tparam Set     Type to be used for returning sets of words.
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, typename Compare, typename Set>
+class frozen_anatree
+{
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Type of each individual character.
+  //////////////////////////////////////////////////////////////////////////////
+  using value_type = typename T::value_type;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Sorted characters of a word.
+  //////////////////////////////////////////////////////////////////////////////
+  using key_type = anatree_internal::key_buffer<value_type>;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Type of indices into the arrays.
+  //////////////////////////////////////////////////////////////////////////////
+  using idx_type = uint32_t;
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Non-owning view of a word within the frozen Anatree.
+  //////////////////////////////////////////////////////////////////////////////
+  using view_type = std::basic_string_view<value_type>;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Identifier of a word within the frozen Anatree, i.e. its index
+  ///        within the pool of all words.
+  ///
+  /// \details The anagrams of each key have consecutive identifiers.
+  //////////////////////////////////////////////////////////////////////////////
+  using word_id = idx_type;
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Individual node of the frozen Anatree.
+  //////////////////////////////////////////////////////////////////////////////
+  struct node
+  {
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Index of the shared NIL leaf.
+    ////////////////////////////////////////////////////////////////////////////
+    static constexpr idx_type nil = 0u;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Character of NIL nodes (see `anatree_internal::nil_char`).
+    ////////////////////////////////////////////////////////////////////////////
+    static constexpr value_type NIL = anatree_internal::nil_char<value_type, Compare>();
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Character in this node.
+    ////////////////////////////////////////////////////////////////////////////
+    value_type m_char = NIL;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Whether the path to this node is the key of some words.
+    ////////////////////////////////////////////////////////////////////////////
+    bool m_has_words = false;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Number of copies of `m_char` on the path to the 'true' child.
+    ///
+    /// \details A chain of nodes with the same character, where each but the
+    ///          first has neither words nor a 'false' child (e.g. the tails of
+    ///          keys such as "aaaacccc"), is stored as a single node.
+    ////////////////////////////////////////////////////////////////////////////
+    uint16_t m_run = 1u;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Index of the 'false' and the 'true' child.
+    ////////////////////////////////////////////////////////////////////////////
+    idx_type m_children[2] = { nil, nil };
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Number of nodes with words in the subtree (including this one).
+    ///
+    /// \details The keys within the subtree of a node are numbered in the order
+    ///          of a depth-first traversal: (1) the node itself, if it has
+    ///          words, (2) its 'true' subtree, and (3) its 'false' subtree.
+    ///          Hence, skipping a subtree skips this many keys.
+    ////////////////////////////////////////////////////////////////////////////
+    idx_type m_subtree_keys = 0u;
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Index of the root.
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr idx_type m_root = 1u;
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Header of the binary format.
+  ///
+  /// \details The header is followed by the array of nodes, the array of key
+  ///          offsets, the array of word offsets, and the array of characters;
+  ///          each starting at a multiple of `alignment`. The storage itself
+  ///          is aligned to `alignment` (see `allocate`) or to a page (if it
+  ///          is memory-mapped), so the arrays are aligned in memory too.
+  //////////////////////////////////////////////////////////////////////////////
+  struct header
+  {
+    char     m_magic[8];
+    uint32_t m_version;
+    uint32_t m_endianness;
+    uint32_t m_char_size;
+    uint32_t m_node_size;
+    uint64_t m_tree_size;
+    uint64_t m_nodes;
+    uint64_t m_keys;
+    uint64_t m_words;
+    uint64_t m_chars;
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Identifier at the start of each file.
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr char magic[8] = "ANATREE";
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Version of the binary format. This is to be incremented whenever
+  ///        the layout changes.
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr uint32_t version = 3u;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Value to identify the byte order of the machine that wrote it.
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr uint32_t endianness = 0x01020304u;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Alignment of each array within the binary format.
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr size_t alignment = 64u;
+
+  static_assert(sizeof(header) <= alignment);
+  static_assert(alignof(node) <= alignment);
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Comparator for characters.
+  //////////////////////////////////////////////////////////////////////////////
+  Compare m_char_comp = Compare();
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Immutable storage in the binary format, i.e. either owned memory
+  ///        or a memory-mapped file. This is shared between all copies.
+  //////////////////////////////////////////////////////////////////////////////
+  std::shared_ptr<const std::byte> m_storage;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of bytes in `m_storage`.
+  //////////////////////////////////////////////////////////////////////////////
+  size_t m_storage_size = 0u;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief All (unique) nodes in depth-first order, starting with the NIL leaf
+  ///        and the root.
+  ///
+  /// \details The 'true' child of a node is placed immediately after it, unless
+  ///          it is shared and has already been placed elsewhere.
+  //////////////////////////////////////////////////////////////////////////////
+  std::span<const node> m_nodes;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief For each key (see `node::m_subtree_keys`), the index of its first
+  ///        word in `m_words`. The last entry marks the end of the last word.
+  //////////////////////////////////////////////////////////////////////////////
+  std::span<const idx_type> m_keys;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief For each word, the index of its first character in `m_chars`. The
+  ///        last entry marks the end of the last word.
+  //////////////////////////////////////////////////////////////////////////////
+  std::span<const idx_type> m_words;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Characters of all words (concatenated).
+  //////////////////////////////////////////////////////////////////////////////
+  std::span<const value_type> m_chars;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of nodes (including NIL) in the original tree.
+  //////////////////////////////////////////////////////////////////////////////
+  size_t m_tree_size = 1u;
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Constructor of an empty frozen Anatree.
+  //////////////////////////////////////////////////////////////////////////////
+  frozen_anatree(Compare char_comp = Compare())
+    : m_char_comp(char_comp)
+  {
+    pack(std::vector<node>(2), std::vector<idx_type>(1, 0u), std::vector<idx_type>(1, 0u), {});
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Create a frozen copy of the given Anatree.
+  ///
+  /// \warning Requires \f$O(N)\f$ time.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename Map>
+  explicit
+  frozen_anatree(const anatree<T, Compare, Set, Map> &a)
+    : m_char_comp(a.m_char_comp)
+    , m_tree_size(a.m_tree_size)
+  {
+    using anatree_t = anatree<T, Compare, Set, Map>;
+    using anatree_ptr = typename anatree_t::node_ptr;
+
+    constexpr idx_type null = std::numeric_limits<idx_type>::max();
+
+    // The 'true' child of `p` (in `a`) and the number of copies of its
+    // character up to it, i.e. the chain of 'true' children with the same
+    // character is merged until one of them has words or a 'false' child.
+    const auto true_run = [&a](const anatree_ptr p) {
+      const auto &n = a.m_nodes[p];
+
+      anatree_ptr p_true = n.m_children[true];
+      uint16_t run = 1u;
+      while (run < std::numeric_limits<uint16_t>::max()) {
+        const auto &n_true = a.m_nodes[p_true];
+        if (n_true.m_char != n.m_char
+            || n_true.m_words != anatree_t::node::no_words
+            || n_true.m_children[false] != anatree_t::node::nil) {
+          break;
+        }
+        ++run;
+        p_true = n_true.m_children[true];
+      }
+      return std::pair<anatree_ptr, uint16_t>(p_true, run);
+    };
+
+    // Hash-cons all nodes bottom-up, such that structurally equal subtrees
+    // become the same node of the DAG. Since the children of a node already
+    // are unique, it suffices to compare its own content.
+    const auto node_hash = [](const node &n) {
+      size_t h = std::hash<uint64_t>()((uint64_t(n.m_children[false]) << 32) | n.m_children[true]);
+      h ^= ((size_t(n.m_run) << 1) | n.m_has_words) * 0x9E3779B97F4A7C15u;
+      if constexpr (std::is_integral_v<value_type>) {
+        h ^= std::hash<value_type>()(n.m_char) + (h << 6) + (h >> 2);
+      }
+      return h;
+    };
+    const auto node_eq = [](const node &x, const node &y) {
+      return x.m_char == y.m_char
+          && x.m_has_words == y.m_has_words
+          && x.m_run == y.m_run
+          && x.m_children[false] == y.m_children[false]
+          && x.m_children[true] == y.m_children[true];
+    };
+
+    std::vector<node> dag(1);
+    std::unordered_map<node, idx_type, decltype(node_hash), decltype(node_eq)>
+      unique(a.m_nodes.size(), node_hash, node_eq);
+    unique.emplace(dag[node::nil], node::nil);
+
+    // Index of each node of `a` within the DAG.
+    std::vector<idx_type> dag_of(a.m_nodes.size(), null);
+    dag_of[anatree_t::node::nil] = node::nil;
+
+    // Post-order traversal with an explicit stack: a node stays on the stack
+    // until both of its children have been placed in the DAG.
+    std::vector<anatree_ptr> stack;
+    if (a.m_root != anatree_t::node::nil) { stack.push_back(a.m_root); }
+
+    while (!stack.empty()) {
+      const anatree_ptr p = stack.back();
+      const auto &n = a.m_nodes[p];
+
+      node dn;
+      dn.m_char      = n.m_char;
+      dn.m_has_words = !a.words_of(p).empty();
+
+      if (n.m_char != anatree_t::node::NIL) {
+        const auto [p_true, run] = true_run(p);
+        const anatree_ptr p_false = n.m_children[false];
+
+        if (dag_of[p_false] == null || dag_of[p_true] == null) {
+          if (dag_of[p_false] == null) { stack.push_back(p_false); }
+          if (dag_of[p_true]  == null) { stack.push_back(p_true); }
+          continue;
+        }
+
+        dn.m_run = run;
+        dn.m_children[false] = dag_of[p_false];
+        dn.m_children[true]  = dag_of[p_true];
+      }
+      stack.pop_back();
+
+      dn.m_subtree_keys = dn.m_has_words
+        + dag[dn.m_children[false]].m_subtree_keys
+        + dag[dn.m_children[true]].m_subtree_keys;
+
+      assert(dag.size() < null);
+      const auto [it, is_new] = unique.try_emplace(dn, dag.size());
+      if (is_new) { dag.push_back(dn); }
+      dag_of[p] = it->second;
+    }
+
+    // Place the nodes of the DAG in depth-first order, with the root at
+    // index 1. Each node is placed when it is reached for the first time.
+    std::vector<node> nodes(1);
+    nodes.reserve(dag.size() + 1u);
+
+    std::vector<idx_type> place(dag.size(), null);
+    place[node::nil] = node::nil;
+
+    std::vector<idx_type> dag_stack;
+    const idx_type dag_root = dag_of[a.m_root];
+    if (dag_root == node::nil) {
+      nodes.push_back(node());
+    } else {
+      dag_stack.push_back(dag_root);
+    }
+
+    while (!dag_stack.empty()) {
+      const idx_type q = dag_stack.back();
+      dag_stack.pop_back();
+      if (place[q] != null) { continue; }
+
+      place[q] = nodes.size();
+      nodes.push_back(dag[q]);
+
+      // Push 'false' child first, such that the 'true' child is placed next.
+      if (place[dag[q].m_children[false]] == null) { dag_stack.push_back(dag[q].m_children[false]); }
+      if (place[dag[q].m_children[true]]  == null) { dag_stack.push_back(dag[q].m_children[true]); }
+    }
+
+    for (size_t i = m_root; i < nodes.size(); ++i) {
+      nodes[i].m_children[false] = place[nodes[i].m_children[false]];
+      nodes[i].m_children[true]  = place[nodes[i].m_children[true]];
+    }
+
+    // Number the words in the order of their keys (see `m_subtree_keys`) by
+    // a depth-first traversal of the original tree.
+    std::vector<idx_type> keys;
+    keys.reserve(nodes[m_root].m_subtree_keys + 1u);
+
+    std::vector<idx_type> words;
+    words.reserve(a.m_size + 1u);
+
+    std::vector<value_type> chars;
+
+    if (a.m_root != anatree_t::node::nil) { stack.push_back(a.m_root); }
+
+    while (!stack.empty()) {
+      const anatree_ptr p = stack.back();
+      stack.pop_back();
+
+      if (!a.words_of(p).empty()) {
+        keys.push_back(words.size());
+        for (const T &w : a.words_of(p)) {
+          assert(chars.size() < null);
+          words.push_back(chars.size());
+          chars.insert(chars.end(), w.begin(), w.end());
+        }
+      }
+
+      const auto &n = a.m_nodes[p];
+      if (n.m_char == anatree_t::node::NIL) { continue; }
+
+      // Push 'false' child first, such that the 'true' child is visited next.
+      if (n.m_children[false] != anatree_t::node::nil) {
+        stack.push_back(n.m_children[false]);
+      }
+      assert(true_run(p).first != anatree_t::node::nil);
+      stack.push_back(true_run(p).first);
+    }
+    assert(keys.size() == nodes[m_root].m_subtree_keys);
+
+    keys.push_back(words.size());
+    words.push_back(chars.size());
+
+    pack(nodes, keys, words, chars);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Copy-constructor, sharing the (immutable) storage of the other.
+  //////////////////////////////////////////////////////////////////////////////
+  frozen_anatree(const frozen_anatree &) = default;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Move-constructor.
+  //////////////////////////////////////////////////////////////////////////////
+  frozen_anatree(frozen_anatree &&) = default;
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Constructor for storage in the binary format.
+  //////////////////////////////////////////////////////////////////////////////
+  frozen_anatree(std::shared_ptr<const std::byte> storage,
+                 const size_t storage_size,
+                 Compare char_comp)
+    : m_char_comp(char_comp)
+  {
+    unpack(std::move(storage), storage_size);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Round `i` up to the next multiple of `alignment`.
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr size_t
+  align(const size_t i)
+  {
+    return (i + alignment - 1u) / alignment * alignment;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Offset behind an array of `n` elements of `elem_size` bytes that
+  ///        starts at `offset`.
+  ///
+  /// \throws std::runtime_error if the offset does not fit into a `size_t`.
+  //////////////////////////////////////////////////////////////////////////////
+  static size_t
+  end_of(const size_t offset, const uint64_t n, const size_t elem_size)
+  {
+    constexpr size_t max = std::numeric_limits<size_t>::max();
+    if (elem_size != 0u && n > (max - offset) / elem_size) {
+      throw std::runtime_error("frozen_anatree: corrupted header");
+    }
+    return offset + static_cast<size_t>(n) * elem_size;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Offset of the next array behind an array of `n` elements of
+  ///        `elem_size` bytes that starts at `offset`.
+  ///
+  /// \throws std::runtime_error if the offset does not fit into a `size_t`.
+  //////////////////////////////////////////////////////////////////////////////
+  static size_t
+  aligned_end_of(const size_t offset, const uint64_t n, const size_t elem_size)
+  {
+    const size_t end = end_of(offset, n, elem_size);
+    if (end > std::numeric_limits<size_t>::max() - alignment) {
+      throw std::runtime_error("frozen_anatree: corrupted header");
+    }
+    return align(end);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Allocate `size` bytes of storage aligned to `alignment`, such that
+  ///        each array within it is aligned to `alignment` too.
+  //////////////////////////////////////////////////////////////////////////////
+  static std::shared_ptr<std::byte>
+  allocate(const size_t size)
+  {
+    std::byte *p = static_cast<std::byte*>(::operator new(size, std::align_val_t(alignment)));
+    return std::shared_ptr<std::byte>(p, [](std::byte *q) {
+      ::operator delete(q, std::align_val_t(alignment));
+    });
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Write the node `n` to (zeroed) storage at `out` member by member,
+  ///        such that its padding bytes stay zero.
+  //////////////////////////////////////////////////////////////////////////////
+  static void
+  store_node(std::byte *out, const node &n)
+  {
+    std::memcpy(out + offsetof(node, m_char),         &n.m_char,         sizeof(n.m_char));
+    std::memcpy(out + offsetof(node, m_has_words),    &n.m_has_words,    sizeof(n.m_has_words));
+    std::memcpy(out + offsetof(node, m_run),          &n.m_run,          sizeof(n.m_run));
+    std::memcpy(out + offsetof(node, m_children),     &n.m_children,     sizeof(n.m_children));
+    std::memcpy(out + offsetof(node, m_subtree_keys), &n.m_subtree_keys, sizeof(n.m_subtree_keys));
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Copy the given arrays into new storage in the binary format.
+  ///
+  /// \details All bytes that do not belong to a value, i.e. the gaps between
+  ///          the arrays and the padding within each node, are zero. Hence,
+  ///          the same tree is always stored as the same bytes.
+  //////////////////////////////////////////////////////////////////////////////
+  void
+  pack(const std::vector<node> &nodes,
+       const std::vector<idx_type> &keys,
+       const std::vector<idx_type> &words,
+       const std::vector<value_type> &chars)
+  {
+    header h;
+    std::memset(&h, 0, sizeof(header));
+    std::memcpy(h.m_magic, magic, sizeof(magic));
+    h.m_version    = version;
+    h.m_endianness = endianness;
+    h.m_char_size  = sizeof(value_type);
+    h.m_node_size  = sizeof(node);
+    h.m_tree_size  = m_tree_size;
+    h.m_nodes      = nodes.size();
+    h.m_keys       = keys.size();
+    h.m_words      = words.size();
+    h.m_chars      = chars.size();
+
+    const size_t nodes_offset = align(sizeof(header));
+    const size_t keys_offset  = align(nodes_offset + nodes.size() * sizeof(node));
+    const size_t words_offset = align(keys_offset + keys.size() * sizeof(idx_type));
+    const size_t chars_offset = align(words_offset + words.size() * sizeof(idx_type));
+    const size_t storage_size = chars_offset + chars.size() * sizeof(value_type);
+
+    std::shared_ptr<std::byte> storage = allocate(storage_size);
+    std::memset(storage.get(), 0, storage_size);
+    std::memcpy(storage.get(), &h, sizeof(header));
+    for (size_t i = 0u; i < nodes.size(); ++i) {
+      store_node(storage.get() + nodes_offset + i * sizeof(node), nodes[i]);
+    }
+    std::memcpy(storage.get() + keys_offset, keys.data(), keys.size() * sizeof(idx_type));
+    std::memcpy(storage.get() + words_offset, words.data(), words.size() * sizeof(idx_type));
+    if (!chars.empty()) {
+      std::memcpy(storage.get() + chars_offset, chars.data(), chars.size() * sizeof(value_type));
+    }
+
+    unpack(std::move(storage), storage_size);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Take over the given storage in the binary format and place all
+  ///        arrays on top of it.
+  ///
+  /// \details All nodes and offsets are validated (see `validate()`), such
+  ///          that no query on corrupted storage can access memory outside of
+  ///          it or fail to terminate.
+  ///
+  /// \pre `storage` is aligned to `alignment`.
+  ///
+  /// \throws std::runtime_error if the storage is not in a compatible format
+  ///         or is corrupted.
+  //////////////////////////////////////////////////////////////////////////////
+  void
+  unpack(std::shared_ptr<const std::byte> storage, const size_t storage_size)
+  {
+    assert(reinterpret_cast<uintptr_t>(storage.get()) % alignment == 0u);
+
+    header h;
+    if (storage_size < sizeof(header)) {
+      throw std::runtime_error("frozen_anatree: missing header");
+    }
+    std::memcpy(&h, storage.get(), sizeof(header));
+
+    if (std::memcmp(h.m_magic, magic, sizeof(magic)) != 0) {
+      throw std::runtime_error("frozen_anatree: not an anatree");
+    }
+    if (h.m_version != version) {
+      throw std::runtime_error("frozen_anatree: unsupported version");
+    }
+    if (h.m_endianness != endianness
+        || h.m_char_size != sizeof(value_type)
+        || h.m_node_size != sizeof(node)) {
+      throw std::runtime_error("frozen_anatree: incompatible layout");
+    }
+
+    const size_t nodes_offset = align(sizeof(header));
+    const size_t keys_offset  = aligned_end_of(nodes_offset, h.m_nodes, sizeof(node));
+    const size_t words_offset = aligned_end_of(keys_offset, h.m_keys, sizeof(idx_type));
+    const size_t chars_offset = aligned_end_of(words_offset, h.m_words, sizeof(idx_type));
+    if (h.m_nodes < 2u || h.m_keys < 1u || h.m_words < 1u
+        || storage_size < end_of(chars_offset, h.m_chars, sizeof(value_type))) {
+      throw std::runtime_error("frozen_anatree: truncated");
+    }
+
+    m_tree_size    = h.m_tree_size;
+    m_storage      = std::move(storage);
+    m_storage_size = storage_size;
+
+    m_nodes = std::span<const node>(
+      reinterpret_cast<const node*>(m_storage.get() + nodes_offset), h.m_nodes);
+    m_keys = std::span<const idx_type>(
+      reinterpret_cast<const idx_type*>(m_storage.get() + keys_offset), h.m_keys);
+    m_words = std::span<const idx_type>(
+      reinterpret_cast<const idx_type*>(m_storage.get() + words_offset), h.m_words);
+    m_chars = std::span<const value_type>(
+      reinterpret_cast<const value_type*>(m_storage.get() + chars_offset), h.m_chars);
+
+    validate();
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Check all invariants the queries rely on.
+  ///
+  /// \details In a single pass over all nodes, this checks that
+  ///
+  ///          - all children are within `m_nodes` and the first node is the
+  ///            NIL leaf,
+  ///
+  ///          - the character of a 'false' child is larger and the one of a
+  ///            'true' child is not smaller (unless it is a NIL leaf), i.e. each
+  ///            step of a query either consumes a character of the key or
+  ///            moves on to a larger character (hence, there are no cycles),
+  ///
+  ///          - each run is at least one character long,
+  ///
+  ///          - the number of keys in each subtree adds up, such that the rank
+  ///            of every key is within `m_keys`, and
+  ///
+  ///          - the key and word offsets are ascending and within `m_words`
+  ///            and `m_chars`, respectively.
+  ///
+  /// \throws std::runtime_error if any of them is violated.
+  //////////////////////////////////////////////////////////////////////////////
+  void
+  validate() const
+  {
+    const auto corrupted = []() {
+      throw std::runtime_error("frozen_anatree: corrupted");
+    };
+
+    // Read `m_has_words` as a byte, since any value other than 0 and 1 is not
+    // a valid `bool`.
+    const auto has_words = [](const node &n) -> uint64_t {
+      unsigned char b;
+      std::memcpy(&b, &n.m_has_words, 1u);
+      return b;
+    };
+
+    const node &nil = m_nodes[node::nil];
+    if (nil.m_char != node::NIL || has_words(nil) != 0u || nil.m_subtree_keys != 0u
+        || nil.m_children[false] != node::nil || nil.m_children[true] != node::nil) {
+      corrupted();
+    }
+
+    for (const node &n : m_nodes) {
+      if (has_words(n) > 1u || n.m_run == 0u) { corrupted(); }
+
+      const idx_type f = n.m_children[false];
+      const idx_type t = n.m_children[true];
+      if (m_nodes.size() <= f || m_nodes.size() <= t) { corrupted(); }
+
+      // Every query stops at a NIL leaf, so only the order of the others matters.
+      if (n.m_char != node::NIL) {
+        const value_type fc = m_nodes[f].m_char;
+        const value_type tc = m_nodes[t].m_char;
+        if (fc != node::NIL && !m_char_comp(n.m_char, fc)) { corrupted(); }
+        if (tc != node::NIL && m_char_comp(tc, n.m_char)) { corrupted(); }
+      }
+
+      const uint64_t subtree_keys = has_words(n)
+        + uint64_t(m_nodes[f].m_subtree_keys) + uint64_t(m_nodes[t].m_subtree_keys);
+      if (n.m_subtree_keys != subtree_keys) { corrupted(); }
+    }
+
+    if (m_nodes[m_root].m_subtree_keys != m_keys.size() - 1u) { corrupted(); }
+
+    const auto ascending_within = [](const std::span<const idx_type> offsets, const size_t size) {
+      return std::is_sorted(offsets.begin(), offsets.end()) && offsets.back() <= size;
+    };
+    if (!ascending_within(m_keys, m_words.size() - 1u)
+        || !ascending_within(m_words, m_chars.size())) {
+      corrupted();
+    }
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Write the frozen Anatree to the file at `path` in a binary format
+  ///        that can be loaded again with `load(...)` or `load_mmap(...)`.
+  ///
+  /// \throws std::runtime_error if the file cannot be written.
+  //////////////////////////////////////////////////////////////////////////////
+  void
+  save(const std::string &path) const
+  requires std::is_trivially_copyable_v<typename T::value_type>
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(m_storage.get()), m_storage_size);
+    if (!out) {
+      throw std::runtime_error("frozen_anatree: cannot write '" + path + "'");
+    }
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Read a frozen Anatree from the file at `path` into memory.
+  ///
+  /// \param char_comp The ordering of characters the Anatree was saved with
+  ///                  (if `Compare` is stateful).
+  ///
+  /// \throws std::runtime_error if the file cannot be read or is incompatible.
+  //////////////////////////////////////////////////////////////////////////////
+  static frozen_anatree
+  load(const std::string &path, const Compare char_comp = Compare())
+  requires std::is_trivially_copyable_v<typename T::value_type>
+  {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+      throw std::runtime_error("frozen_anatree: cannot open '" + path + "'");
+    }
+    const std::streamoff end = in.tellg();
+    if (end < 0) {
+      throw std::runtime_error("frozen_anatree: cannot read '" + path + "'");
+    }
+    const size_t storage_size = static_cast<size_t>(end);
+    in.seekg(0);
+
+    std::shared_ptr<std::byte> storage = allocate(storage_size);
+    in.read(reinterpret_cast<char*>(storage.get()), storage_size);
+    if (!in) {
+      throw std::runtime_error("frozen_anatree: cannot read '" + path + "'");
+    }
+    return frozen_anatree(std::move(storage), storage_size, char_comp);
+  }
+
+#ifdef ANATREE_HAS_MMAP
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Map the file at `path` into memory and run all queries directly on
+  ///        the (read-only and shared) mapped pages.
+  ///
+  /// \details No node is deserialized, but all of them are validated in a
+  ///          single pass (see `validate()`). The file is unmapped when the
+  ///          last copy is destructed.
+  ///
+  /// \param char_comp The ordering of characters the Anatree was saved with
+  ///                  (if `Compare` is stateful).
+  ///
+  /// \throws std::runtime_error if the file cannot be mapped or is
+  ///         incompatible.
+  //////////////////////////////////////////////////////////////////////////////
+  static frozen_anatree
+  load_mmap(const std::string &path, const Compare char_comp = Compare())
+  requires std::is_trivially_copyable_v<typename T::value_type>
+  {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("frozen_anatree: cannot open '" + path + "'");
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+      ::close(fd);
+      throw std::runtime_error("frozen_anatree: cannot read '" + path + "'");
+    }
+    const size_t storage_size = st.st_size;
+
+    void *addr = ::mmap(nullptr, storage_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+      throw std::runtime_error("frozen_anatree: cannot map '" + path + "'");
+    }
+
+    const auto unmap = [storage_size](const std::byte *p) {
+      ::munmap(const_cast<std::byte*>(p), storage_size);
+    };
+    return frozen_anatree(std::shared_ptr<const std::byte>(static_cast<const std::byte*>(addr), unmap),
+                          storage_size, char_comp);
+  }
+#endif
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Whether there exists an anagrams of 'w'.
+  ///
+  /// \details An anagram is a word that can be created from (all) the letters
+  ///          of 'w'.
+  //////////////////////////////////////////////////////////////////////////////
+  bool
+  has_anagram_of(const T &w) const
+  {
+    const auto [begin, end] = find_words(w);
+    return begin < end;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Obtain all words that are anagrams of 'w'.
+  ///
+  /// \details An anagram is a word that can be created from (all) the letters
+  ///          of 'w'.
+  //////////////////////////////////////////////////////////////////////////////
+  Set
+  anagrams_of(const T &w) const
+  {
+    Set res;
+    const auto [begin, end] = find_words(w);
+    for (idx_type i = begin; i < end; ++i) {
+      res.insert(word(i));
+    }
+    return res;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Obtain all words that are subanagrams of 'w'.
+  ///
+  /// \details A subanagram is a word that can be created from some (but not
+  ///          necessarily all) letters of 'w'.
+  //////////////////////////////////////////////////////////////////////////////
+  Set
+  subanagrams_of(const T &w) const
+  {
+    Set res;
+    subanagrams_of__iter(sorted_key(w), [this, &res](const idx_type begin, const idx_type end) {
+      for (idx_type i = begin; i < end; ++i) {
+        res.insert(word(i));
+      }
+      return true;
+    });
+    return res;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Call `f` on each word that is a subanagram of 'w'.
+  ///
+  /// \details Each word is provided as a view into the pool of words, i.e.
+  ///          without copying it. If `f` returns a `bool`, then the search
+  ///          stops as soon as it returns `false`.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename F>
+  requires std::invocable<F, view_type>
+  void
+  subanagrams_of(const T &w, F &&f) const
+  {
+    subanagrams_of__iter(sorted_key(w), [this, &f](const idx_type begin, const idx_type end) {
+      for (idx_type i = begin; i < end; ++i) {
+        if constexpr (std::is_convertible_v<std::invoke_result_t<F&, view_type>, bool>) {
+          if (!f(word_view(i))) { return false; }
+        } else {
+          f(word_view(i));
+        }
+      }
+      return true;
+    });
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief The word with identifier `i` as a view into the pool of words.
+  ///
+  /// \pre `i < size()`
+  //////////////////////////////////////////////////////////////////////////////
+  view_type
+  word_view(const word_id i) const
+  {
+    assert(i < size());
+    return view_type(m_chars.data() + m_words[i], m_words[i+1] - m_words[i]);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Identifiers of all words that are anagrams of 'w'.
+  ///
+  /// \details These are consecutive, i.e. no memory is allocated for them.
+  //////////////////////////////////////////////////////////////////////////////
+  std::ranges::iota_view<word_id, word_id>
+  anagram_ids_of(const T &w) const
+  {
+    const auto [begin, end] = find_words(w);
+    return std::ranges::iota_view<word_id, word_id>(begin, end);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Identifiers of all words that are subanagrams of 'w' in ascending
+  ///        order.
+  ///
+  /// \details Unlike with `subanagrams_of`, no words are copied. Results can
+  ///          be combined with integer operations, e.g. `std::set_union`.
+  //////////////////////////////////////////////////////////////////////////////
+  std::vector<word_id>
+  subanagram_ids_of(const T &w) const
+  {
+    std::vector<word_id> res;
+    subanagrams_of__iter(sorted_key(w), [&res](const idx_type begin, const idx_type end) {
+      for (idx_type i = begin; i < end; ++i) {
+        res.push_back(i);
+      }
+      return true;
+    });
+    std::sort(res.begin(), res.end());
+    return res;
+  }
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Call `visit` on the range of word identifiers of each node that
+  ///        holds subanagrams of `key`. The search stops as soon as `visit`
+  ///        returns `false`.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename Visit>
+  void
+  subanagrams_of__iter(const key_type &key, Visit &&visit) const
+  {
+    // Depth-first traversal with an explicit stack of nodes, the position
+    // within the key, and the number of the first key in its subtree.
+    std::vector<std::tuple<idx_type, size_t, idx_type>> stack;
+    stack.push_back({ m_root, 0u, 0u });
+
+    while (!stack.empty()) {
+      auto [p, k, r] = stack.back();
+      stack.pop_back();
+
+      // Follow the chain of 'false' children, pushing the 'true' ones.
+      while (true) {
+        const node &n = m_nodes[p];
+
+        if (n.m_has_words) {
+          if (!visit(m_keys[r], m_keys[r+1])) { return; }
+          ++r;
+        }
+
+        const value_type c = n.m_char;
+
+        // Case: Anatree is done
+        if (c == node::NIL) { break; }
+
+        // Case: Iterator behind
+        // -> Skip missing characters
+        while (k < key.size() && m_char_comp(key[k], c)) { ++k; }
+
+        // Case: Iterator done
+        if (k == key.size()) { break; }
+
+        // Case: Iterator and node matches
+        // -> Follow both children. The 'true' child needs all `m_run` copies
+        //    of the character, which (since the key is sorted) is the case if
+        //    the last of them matches too.
+        if (!m_char_comp(c, key[k])) {
+          const size_t run = n.m_run;
+          if (run <= key.size() - k && !m_char_comp(c, key[k + run - 1u])) {
+            stack.push_back({ n.m_children[true], k + run, r });
+          }
+          ++k;
+        }
+
+        // Case: Iterator ahead (or matches)
+        // -> Follow 'false' child
+        r += m_nodes[n.m_children[true]].m_subtree_keys;
+        p = n.m_children[false];
+      }
+    }
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Whether the frozen Anatree includes the word 'w'.
+  //////////////////////////////////////////////////////////////////////////////
+  bool
+  contains(const T &w) const
+  {
+    const auto [begin, end] = find_words(w);
+    for (idx_type i = begin; i < end; ++i) {
+      if (std::equal(w.begin(), w.end(),
+                     m_chars.begin() + m_words[i],
+                     m_chars.begin() + m_words[i+1])) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of stored words.
+  //////////////////////////////////////////////////////////////////////////////
+  size_t
+  size() const
+  {
+    return m_words.size() - 1u;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Whether the frozen Anatree is empty.
+  //////////////////////////////////////////////////////////////////////////////
+  bool
+  empty() const
+  {
+    return size() == 0u;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of nodes within the original tree (including all NIL
+  ///        leaves).
+  //////////////////////////////////////////////////////////////////////////////
+  size_t
+  tree_size() const
+  {
+    return m_tree_size;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of nodes (including the NIL leaf) actually stored, i.e.
+  ///        after sharing structurally equal subtrees and merging runs of the
+  ///        same character.
+  //////////////////////////////////////////////////////////////////////////////
+  size_t
+  dag_size() const
+  {
+    return m_nodes.size();
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of bytes used for the nodes and the words, i.e. the size of
+  ///        the binary format.
+  //////////////////////////////////////////////////////////////////////////////
+  size_t
+  memory_size() const
+  {
+    return m_storage_size;
+  }
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Obtain a copy of the `i`th word.
+  //////////////////////////////////////////////////////////////////////////////
+  T
+  word(const idx_type i) const
+  {
+    return T(m_chars.begin() + m_words[i], m_chars.begin() + m_words[i+1]);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Creates the key of the word 'w', i.e. its characters sorted.
+  //////////////////////////////////////////////////////////////////////////////
+  key_type
+  sorted_key(const T &w) const
+  {
+    return key_type(w.begin(), w.end(), m_char_comp);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Traverses the frozen Anatree in search of the node corresponding
+  ///        to `w`.
+  ///
+  /// \returns Range of the identifiers of the anagrams of `w`. If there are
+  ///          none, then the range is empty.
+  //////////////////////////////////////////////////////////////////////////////
+  std::pair<idx_type, idx_type>
+  find_words(const T &w) const
+  {
+    const key_type key = sorted_key(w);
+
+    idx_type p = m_root;
+    idx_type r = 0u;
+    for (size_t k = 0; k < key.size();) {
+      const node &n = m_nodes[p];
+      const value_type c = n.m_char;
+
+      // Case: Iterator behind or tree is done
+      // -> No words with all letters exist.
+      if (c == node::NIL || m_char_comp(key[k], c)) { return { 0u, 0u }; }
+
+      r += n.m_has_words;
+
+      // Case: Iterator ahead
+      // -> Follow 'false' child (skipping the keys of the 'true' subtree)
+      if (m_char_comp(c, key[k])) {
+        r += m_nodes[n.m_children[true]].m_subtree_keys;
+        p = n.m_children[false];
+        continue;
+      }
+
+      // Case: Iterator and node matches
+      // -> Follow 'true' child, if the key has all `m_run` copies of 'c'.
+      const size_t run = n.m_run;
+      if (key.size() - k < run || m_char_comp(c, key[k + run - 1u])) { return { 0u, 0u }; }
+
+      p = n.m_children[true];
+      k += run;
+    }
+
+    if (!m_nodes[p].m_has_words) { return { 0u, 0u }; }
+    return { m_keys[r], m_keys[r+1] };
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Thread-safe version of `anatree<...>` for a dictionary that is being
+///        queried by many threads while it is updated.
+///
+/// \details Readers obtain an immutable snapshot of the current version of the
+///          Anatree by (atomically) loading a `std::shared_ptr` to it. Hence,
+///          readers never block on writers' updates: they only contend with
+///          writers for the moment it takes to load or publish a version.
+///          Writers are serialized among themselves. Each update is applied
+///          to a private copy of the current version, which is then published
+///          atomically. Older versions are released when their last reader is
+///          done.
+///
+/// \remark This is not lock-free in general: the standard library may guard
+///         the atomic `std::shared_ptr` with an internal (spin) lock, see
+///         `is_lock_free()`.
+///
+/// \remark Each update copies the tree, which shares all its pages of nodes
+///         until they are changed. Still, changes should be applied in
+///         batches with `update(f)` or `insert(begin, end)`.
+///
+/// \tparam T       Type for words, i.e. lists of elemnts.
+///
+/// \tparam Compare Ordering of the symbols within each word.
+///
+/// \tparam Set     Type to be used for returning sets of words.
+////////////////////////////////////////////////////////////////////////////////
+template<typename T       = std::string,
+         typename Compare = std::less<typename T::value_type>,
+         typename Set     = std::unordered_set<T>>
+class concurrent_anatree
+{
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Type of each version of the Anatree.
+  //////////////////////////////////////////////////////////////////////////////
+  using anatree_type = anatree<T, Compare, Set>;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Shared ownership of an (immutable) version of the Anatree.
+  //////////////////////////////////////////////////////////////////////////////
+  using snapshot_type = std::shared_ptr<const anatree_type>;
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Latest published version.
+  //////////////////////////////////////////////////////////////////////////////
+#ifdef __cpp_lib_atomic_shared_ptr
+  std::atomic<snapshot_type> m_snapshot;
+#else
+  snapshot_type m_snapshot;
+#endif
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Mutual exclusion of writers.
+  //////////////////////////////////////////////////////////////////////////////
+  std::mutex m_writer_mutex;
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Constructor of an empty Anatree.
+  //////////////////////////////////////////////////////////////////////////////
+  concurrent_anatree(Compare char_comp = Compare())
+    : m_snapshot(std::make_shared<const anatree_type>(char_comp))
+  { }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Constructor with the given Anatree as its first version.
+  //////////////////////////////////////////////////////////////////////////////
+  explicit
+  concurrent_anatree(anatree_type &&a)
+    : m_snapshot(std::make_shared<const anatree_type>(std::move(a)))
+  { }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Constructor with the given Anatree as its first version.
+  //////////////////////////////////////////////////////////////////////////////
+  explicit
+  concurrent_anatree(const anatree_type &a)
+    : m_snapshot(std::make_shared<const anatree_type>(a))
+  { }
+
+  concurrent_anatree(const concurrent_anatree&) = delete;
+  concurrent_anatree& operator=(const concurrent_anatree&) = delete;
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Obtain the latest version of the Anatree.
+  ///
+  /// \details The snapshot is unaffected by any later updates. Any number of
+  ///          queries can be run on it without any synchronization.
+  //////////////////////////////////////////////////////////////////////////////
+  snapshot_type
+  snapshot() const
+  {
+#ifdef __cpp_lib_atomic_shared_ptr
+    return m_snapshot.load(std::memory_order_acquire);
+#else
+    return std::atomic_load_explicit(&m_snapshot, std::memory_order_acquire);
+#endif
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Whether loading a snapshot (and publishing a version) is lock-free
+  ///        on this platform.
+  //////////////////////////////////////////////////////////////////////////////
+  bool
+  is_lock_free() const
+  {
+#ifdef __cpp_lib_atomic_shared_ptr
+    return m_snapshot.is_lock_free();
+#else
+    return std::atomic_is_lock_free(&m_snapshot);
+#endif
+  }
+
+private:
+  void
+  publish(snapshot_type &&s)
+  {
+#ifdef __cpp_lib_atomic_shared_ptr
+    m_snapshot.store(std::move(s), std::memory_order_release);
+#else
+    std::atomic_store_explicit(&m_snapshot, std::move(s), std::memory_order_release);
+#endif
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Apply `f` to a copy of the latest version and publish the result
+  ///        as the next version.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename F>
+  requires std::invocable<F, anatree_type&>
+  void
+  update(F &&f)
+  {
+    const std::lock_guard<std::mutex> lock(m_writer_mutex);
+
+    auto next = std::make_shared<anatree_type>(*snapshot());
+    f(*next);
+    publish(std::move(next));
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Adds the word 'w' to the anatree.
+  //////////////////////////////////////////////////////////////////////////////
+  void
+  insert(const T &w)
+  {
+    update([&w](anatree_type &a) { a.insert(w); });
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Adds the words to the anatree as per the iterator (publishing
+  ///        only a single new version).
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename InputIt>
+  requires std::input_iterator<InputIt>
+        && (std::is_convertible<typename InputIt::value_type, T>::value
+            || std::is_same<typename InputIt::value_type, typename anatree_type::view_type>::value)
+  void
+  insert(InputIt begin, InputIt end)
+  {
+    update([&begin, &end](anatree_type &a) { a.insert(begin, end); });
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Removes the word 'w' from the anatree.
+  //////////////////////////////////////////////////////////////////////////////
+  void
+  erase(const T &w)
+  {
+    update([&w](anatree_type &a) { a.erase(w); });
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Removes the words as per the iterator (publishing only a single
+  ///        new version).
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename InputIt>
+  requires std::input_iterator<InputIt>
+        && std::is_convertible<typename InputIt::value_type, T>::value
+  void
+  erase(InputIt begin, InputIt end)
+  {
+    update([&begin, &end](anatree_type &a) { a.erase(begin, end); });
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Remove all nodes/anagrams.
+  //////////////////////////////////////////////////////////////////////////////
+  void
+  clear()
+  {
+    const std::lock_guard<std::mutex> lock(m_writer_mutex);
+
+    auto next = std::make_shared<anatree_type>(*snapshot());
+    next->clear();
+    publish(std::move(next));
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Whether there exists an anagrams of 'w' in the latest version.
+  //////////////////////////////////////////////////////////////////////////////
+  bool
+  has_anagram_of(const T &w) const
+  {
+    return snapshot()->has_anagram_of(w);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Obtain all words that are anagrams of 'w' in the latest version.
+  ///
+  /// \details Unlike `anatree<...>::anagrams_of`, the set is copied, since the
+  ///          version it is part of may be released. Use `snapshot()` to avoid
+  ///          the copy.
+  //////////////////////////////////////////////////////////////////////////////
+  Set
+  anagrams_of(const T &w) const
+  {
+    return snapshot()->anagrams_of(w);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Obtain all words that are subanagrams of 'w' in the latest
+  ///        version.
+  //////////////////////////////////////////////////////////////////////////////
+  Set
+  subanagrams_of(const T &w) const
+  {
+    return snapshot()->subanagrams_of(w);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Whether the latest version includes the word 'w'.
+  //////////////////////////////////////////////////////////////////////////////
+  bool
+  contains(const T &w) const
+  {
+    return snapshot()->contains(w);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of words stored in the latest version.
+  //////////////////////////////////////////////////////////////////////////////
+  size_t
+  size() const
+  {
+    return snapshot()->size();
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Whether the latest version is empty.
+  //////////////////////////////////////////////////////////////////////////////
+  bool
+  empty() const
+  {
+    return snapshot()->empty();
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Anatree that is partitioned into several independent shards, e.g.
+///        to build and query them in parallel or to place each of them on a
+///        separate machine.
+///
+/// \details All anagrams of a word share the same key and hence always end up
+///          in the same shard. Queries for a single key, e.g. `contains` and
+///          `anagrams_of`, are therefore answered by exactly one shard. How
+///          the keys are assigned depends on the `partition`:
+///
+///          - `first_char`: By the first character of the key, i.e. the
+///            smallest one as per `Compare`. Every subanagram of a word only
+///            has characters of that word, so `subanagrams_of` only needs to
+///            ask the shards of the word's characters.
+///
+///          - `key_hash`: By a hash of the entire key. This spreads the words
+///            more evenly, but `subanagrams_of` has to ask every shard.
+///
+///          With the natural order of characters, the first character of
+///          most keys is a common letter, e.g. 'a' or 'e' in English. Use a
+///          `frequency_order` with `rarest_first` to obtain more even shards
+///          by their first character.
+///
+/// \remark The shard of a word is part of the format of the shards saved by
+///         `save(i, path)`: it is the 64-bit FNV-1a hash of the partition's
+///         characters (the smallest one or the entire sorted key), modulo the
+///         number of shards. Each character contributes its `sizeof` bytes
+///         of its unsigned value, least significant byte first. Hence,
+///         `shard_of(w)` can be used to route queries to saved shards from
+///         any build and platform with the same size of `value_type`.
+///
+/// \tparam T       Type for words, i.e. lists of elemnts.
+///
+/// \tparam Compare Ordering of the symbols within each word.
+///
+/// \tparam Set     Type to be used for returning sets of words.
+////////////////////////////////////////////////////////////////////////////////
+template<typename T       = std::string,
+         typename Compare = std::less<typename T::value_type>,
+         typename Set     = std::unordered_set<T>>
+class sharded_anatree
+{
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Type of each shard.
+  //////////////////////////////////////////////////////////////////////////////
+  using anatree_type = anatree<T, Compare, Set>;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Type of each shard, when frozen.
+  //////////////////////////////////////////////////////////////////////////////
+  using frozen_type = frozen_anatree<T, Compare, Set>;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Type of each symbol within a word.
+  //////////////////////////////////////////////////////////////////////////////
+  using value_type = typename T::value_type;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief How keys are assigned to shards.
+  //////////////////////////////////////////////////////////////////////////////
+  enum class partition
+  {
+    /** By the first (i.e. smallest) character of the key. */
+    first_char,
+    /** By a hash of all characters of the key. */
+    key_hash,
+  };
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief The ordering of characters of all shards.
+  //////////////////////////////////////////////////////////////////////////////
+  Compare m_char_comp;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief How keys are assigned to shards.
+  //////////////////////////////////////////////////////////////////////////////
+  partition m_partition;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief The shards (at least one).
+  //////////////////////////////////////////////////////////////////////////////
+  std::vector<anatree_type> m_shards;
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Constructor of an Anatree with `shards` empty shards.
+  ///
+  /// \throws std::invalid_argument if `shards` is zero.
+  //////////////////////////////////////////////////////////////////////////////
+  explicit
+  sharded_anatree(const size_t shards,
+                  const partition part = partition::first_char,
+                  Compare char_comp = Compare())
+    : m_char_comp(char_comp), m_partition(part)
+  {
+    if (shards == 0u) {
+      throw std::invalid_argument("sharded_anatree: at least one shard is required");
     }
-
-    // Case: Iterator and node matches
-    // -> Follow 'true' child
-    p->m_children[true] = insert__rec(std::move(p->m_children[true]), w, ++curr, end);
-    return p;
+    m_shards.reserve(shards);
+    for (size_t i = 0u; i < shards; ++i) { m_shards.emplace_back(char_comp); }
   }
 
-public:
   //////////////////////////////////////////////////////////////////////////////
-  /// \brief Adds the words to the anatree as per the iterator.
+  /// \brief Constructor of an Anatree with `shards` shards from the words in
+  ///        [first, last), see `insert(begin, end)`.
   //////////////////////////////////////////////////////////////////////////////
   template<typename InputIt>
   requires std::input_iterator<InputIt>
         && std::is_convertible<typename InputIt::value_type, T>::value
-  void
-  insert(InputIt begin, InputIt end)
+  sharded_anatree(const size_t shards,
+                  InputIt first, InputIt last,
+                  const partition part = partition::first_char,
+                  Compare char_comp = Compare())
+    : sharded_anatree(shards, part, char_comp)
   {
-    while (begin != end) { insert(*(begin++)); }
+    insert(first, last);
   }
 
 public:
   //////////////////////////////////////////////////////////////////////////////
-  /// \brief Remove all nodes/anagrams.
+  /// \brief Number of shards.
   //////////////////////////////////////////////////////////////////////////////
-  void
-  clear()
+  size_t
+  shards() const
   {
-    m_root = node::make_node();
-    m_size = 0u;
-    m_tree_size = 1u;
+    return m_shards.size();
   }
 
-public:
   //////////////////////////////////////////////////////////////////////////////
-  /// \brief Obtain all words in the Anatree, excluding words that are a
-  ///        subanagram of another one returned.
+  /// \brief Access to the `i`th shard.
   //////////////////////////////////////////////////////////////////////////////
-  Set
-  keys() const
+  const anatree_type&
+  shard(const size_t i) const
   {
-    const auto rec_result = keys__rec(m_root);
-    Set ret;
-    for (const auto [_, v] : rec_result) {
-      ret.insert(v);
-    }
-    return ret;
+    return m_shards.at(i);
   }
 
-private:
-  Map
-  keys__rec(const node_ptr &p) const
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Index of the shard that includes all anagrams of 'w'.
+  ///
+  /// \details The empty word is always placed in the first shard.
+  //////////////////////////////////////////////////////////////////////////////
+  size_t
+  shard_of(const T &w) const
   {
-    // Case: Leaf of Tree
-    // -> Add a word, if any.
-    if (p->m_char == node::NIL) {
-      Map ret;
-      if (p->m_words.size() > 0) {
-        ret[{}] = *p->m_words.begin();
-      }
-      return ret;
-    }
+    if (w.empty()) { return 0u; }
 
-    // Case: Internal Node
-    // -> Recurse for words with and without this character
-    auto rec_true = keys__rec(p->m_children[true]);
-    auto rec_false = keys__rec(p->m_children[false]);
-
-    Map ret;
+    if (m_partition == partition::first_char) {
+      return shard_of__char(*std::min_element(w.begin(), w.end(), m_char_comp));
+    }
 
-    // -> Copy over words excluding current node's character (except for ones
-    //    that are superseeded)
-    for (const auto [rec_false_k, rec_false_v] : rec_false) {
-      // Check whether the word is superseeded by any word in 'rec_true'.
-      // - (a) Simple O(1) case
-      if (rec_true.contains(rec_false_v)) { continue; }
+    // Hash the sorted characters, i.e. the same order for all anagrams.
+    std::vector<value_type> key(w.begin(), w.end());
+    anatree_internal::sort_chars(key.begin(), key.end(), m_char_comp);
 
-      // - (b) Expensive O(T) case
-      bool superseeded = false;
-      for (const auto [rec_true_k, _] : rec_true) {
-        int false_idx = rec_false_k.length() - 1;
-        int true_idx  = rec_true_k.length()  - 1;
+    uint64_t h = fnv_offset;
+    for (const value_type c : key) { h = fnv1a(h, c); }
+    return h % m_shards.size();
+  }
 
-        while (0 <= false_idx && 0 <= true_idx) {
-          const value_type false_char = rec_false_k[false_idx];
-          const value_type true_char  = rec_true_k[true_idx];
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Indices (in ascending order) of all shards that may include
+  ///        subanagrams of 'w'.
+  //////////////////////////////////////////////////////////////////////////////
+  std::vector<size_t>
+  shards_of_subanagrams(const T &w) const
+  {
+    std::vector<size_t> res;
 
-          if (m_char_comp(true_char, false_char)) {
-            true_idx--;
-            continue;
-          } else if (false_char == true_char) {
-            false_idx--;
-            true_idx--;
-            continue;
-          } else { // False includes character not in True path.
-            break;
-          }
-        }
-        if (false_idx < 0 && true_idx < 0) {
-          superseeded = true;
-          break;
-        }
-      }
-      if (superseeded) { continue; }
+    // Case: Partitioned by hash
+    // -> Subanagrams may be anywhere
+    if (m_partition == partition::key_hash) {
+      res.resize(m_shards.size());
+      for (size_t i = 0u; i < res.size(); ++i) { res[i] = i; }
+      return res;
+    }
 
-      // Add word
-      T curr_key(rec_false_k);
-      curr_key.push_back(p->m_char);
+    // Case: Partitioned by first character
+    // -> The first character of a subanagram is one of the characters of 'w'
+    //    (the empty word is in the first shard).
+    res.push_back(0u);
+    for (const value_type c : w) { res.push_back(shard_of__char(c)); }
 
-      assert(!ret.contains(curr_key));
-      ret[curr_key] = rec_false_v;
-    }
-    rec_false.clear(); // <-- Save on memory
+    std::sort(res.begin(), res.end());
+    res.erase(std::unique(res.begin(), res.end()), res.end());
+    return res;
+  }
 
-    // -> Copy over words including current node's character.
-    for (const auto [rec_k, rec_v] : rec_true) {
-      T curr_key(rec_k);
-      curr_key.push_back(p->m_char);
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Parameters of the (64-bit) FNV-1a hash.
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr uint64_t fnv_offset = 0xcbf29ce484222325u;
+  static constexpr uint64_t fnv_prime  = 0x00000100000001b3u;
 
-      ret[curr_key] = rec_v;
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Continue the FNV-1a hash `h` with the bytes of `c`, least
+  ///        significant first (independent of the platform's endianness).
+  //////////////////////////////////////////////////////////////////////////////
+  static uint64_t
+  fnv1a(uint64_t h, const value_type c)
+  {
+    const uint64_t u = static_cast<std::make_unsigned_t<value_type>>(c);
+    for (size_t b = 0u; b < sizeof(value_type); ++b) {
+      h ^= (u >> (8u * b)) & 0xffu;
+      h *= fnv_prime;
     }
-    // rec_true.clear(); // <-- Save on memory (unecessary)
+    return h;
+  }
 
-    return ret;
+  size_t
+  shard_of__char(const value_type c) const
+  {
+    return fnv1a(fnv_offset, c) % m_shards.size();
   }
 
 public:
   //////////////////////////////////////////////////////////////////////////////
-  /// \brief Obtain all words in the Anatree of a certain length, excluding
-  ///        words that are an anagram of another one returned.
-  ///
-  /// \param word_length The length of the desired words.
+  /// \brief Adds the word 'w' to its shard.
   //////////////////////////////////////////////////////////////////////////////
-  Set
-  keys(const size_t word_length) const
+  void
+  insert(const T &w)
   {
-    Set res;
-    keys__rec(word_length, m_root, 0, res);
-    return res;
+    m_shards[shard_of(w)].insert(w);
   }
 
-private:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Adds the words to the shards as per the iterator.
+  ///
+  /// \details The words are first split by their shard. Then, all shards are
+  ///          built in parallel. A shard that already has words is built on
+  ///          the side and then merged into it (see `operator|=`).
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename InputIt>
+  requires std::input_iterator<InputIt>
+        && std::is_convertible<typename InputIt::value_type, T>::value
   void
-  keys__rec(const size_t word_length,
-            const node_ptr &p,
-            const size_t true_edges,
-            Set &res) const
+  insert(InputIt begin, InputIt end)
   {
-    assert(true_edges <= word_length);
+    std::vector<std::vector<T>> parts(m_shards.size());
+    for (; begin != end; ++begin) {
+      T w = *begin;
+      const size_t i = shard_of(w);
+      parts[i].push_back(std::move(w));
+    }
 
-    // Case: Found word of 'word_length'
-    // -> Search succesful (no need to keep on searching deeper)
-    if (word_length == true_edges) {
-      if (p->m_words.size() > 0) {
-        res.insert(*p->m_words.begin());
+    const auto build = [this, &parts](const size_t i) {
+      auto first = std::make_move_iterator(parts[i].begin());
+      auto last  = std::make_move_iterator(parts[i].end());
+
+      if (m_shards[i].empty()) {
+        m_shards[i].insert(first, last);
+      } else {
+        m_shards[i] |= anatree_type(first, last, m_char_comp);
       }
-      return;
-    }
+    };
 
-    // Case: Tree stopped early
-    // -> Abandon subtree
-    if (p->m_char == node::NIL) {
-      return;
+    std::vector<std::future<void>> futures;
+    for (size_t i = 1u; i < m_shards.size(); ++i) {
+      if (parts[i].empty()) { continue; }
+      futures.push_back(std::async(std::launch::async, build, i));
     }
+    if (!parts[0].empty()) { build(0u); }
+    for (auto &f : futures) { f.get(); }
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Removes the word 'w' from its shard.
+  ///
+  /// \returns Number of words removed (0 or 1).
+  //////////////////////////////////////////////////////////////////////////////
+  size_t
+  erase(const T &w)
+  {
+    return m_shards[shard_of(w)].erase(w);
+  }
 
-    // Case: Missing characters
-    // -> Merge recursively from false and true subtrees
-    keys__rec(word_length, p->m_children[true], true_edges+1, res);
-    keys__rec(word_length, p->m_children[false], true_edges, res);
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Remove all words from all shards.
+  //////////////////////////////////////////////////////////////////////////////
+  void
+  clear()
+  {
+    for (anatree_type &a : m_shards) { a.clear(); }
   }
 
 public:
   //////////////////////////////////////////////////////////////////////////////
   /// \brief Whether there exists an anagrams of 'w'.
-  ///
-  /// \details An anagram is a word that can be created from (all) the letters
-  ///          of 'w'.
   //////////////////////////////////////////////////////////////////////////////
   bool
   has_anagram_of(const T &w) const
   {
-    const node_ptr& n = find_node(w);
-    return n && n->m_words.size() > 0;
+    return m_shards[shard_of(w)].has_anagram_of(w);
   }
 
-public:
   //////////////////////////////////////////////////////////////////////////////
   /// \brief Obtain all words that are anagrams of 'w'.
-  ///
-  /// \details An anagram is a word that can be created from (all) the letters
-  ///          of 'w'.
   //////////////////////////////////////////////////////////////////////////////
-  Set
+  const Set&
   anagrams_of(const T &w) const
   {
-    const node_ptr& n = find_node(w);
-    return n ? n->m_words : Set();
+    return m_shards[shard_of(w)].anagrams_of(w);
   }
 
-public:
   //////////////////////////////////////////////////////////////////////////////
   /// \brief Obtain all words that are subanagrams of 'w'.
   ///
-  /// \details A subanagram is a word that can be created from some (but not
-  ///          necessarily all) letters of 'w'.
+  /// \details Only the shards in `shards_of_subanagrams(w)` are searched. If
+  ///          there are several of them with at least `parallel_cutoff` words
+  ///          in total, then each of them is searched on its own thread.
   //////////////////////////////////////////////////////////////////////////////
   Set
   subanagrams_of(const T &w) const
   {
-    T key = sorted_word(w);
-    Set res;
-    subanagrams_of__rec(m_root, key.begin(), key.end(), res);
-    return res;
-  }
+    const std::vector<size_t> is = shards_of_subanagrams(w);
 
-private:
-  void
-  subanagrams_of__rec(const node_ptr &p,
-                      typename T::iterator curr,
-                      const typename T::iterator end,
-                      Set &res) const
-  {
-    res.insert(p->m_words.begin(), p->m_words.end());
+    size_t words = 0u;
+    for (const size_t i : is) { words += m_shards[i].size(); }
 
-    // Case: Anatree is done
-    // -> Stop
-    if (p->m_char == node::NIL) {
-      return;
+    // Case: Not worth the threads
+    // -> Search the shards one after the other.
+    if (is.size() == 1u || words < anatree_type::parallel_cutoff) {
+      Set res;
+      for (const size_t i : is) {
+        Set shard_res = m_shards[i].subanagrams_of(w);
+        anatree_internal::merge_words(res, shard_res);
+      }
+      return res;
     }
 
-    // Case: Iterator behind
-    // -> Skip missing characters
-    while (curr != end && m_char_comp(*curr, p->m_char)) { ++curr; }
-
-    // Case: Iterator done
-    // -> Stop
-    if (curr == end) {
-      return;
+    // Case: Several shards
+    // -> Search each one on its own thread and merge their results.
+    std::vector<std::future<Set>> futures;
+    for (size_t j = 1u; j < is.size(); ++j) {
+      futures.push_back(std::async(std::launch::async, [this, &w, i = is[j]]() {
+        return m_shards[i].subanagrams_of(w);
+      }));
     }
 
-    // Case: Iterator ahead
-    // -> Follow 'false' child
-    if (m_char_comp(p->m_char, *curr)) {
-      subanagrams_of__rec(p->m_children[false], curr, end, res);
-      return;
+    Set res = m_shards[is[0]].subanagrams_of(w);
+    for (auto &f : futures) {
+      Set shard_res = f.get();
+      anatree_internal::merge_words(res, shard_res);
     }
+    return res;
+  }
 
-    // Case: Iterator and node matches
-    // -> Follow both children, merge results and add words on current node
-    ++curr;
-    subanagrams_of__rec(p->m_children[false], curr, end, res);
-    subanagrams_of__rec(p->m_children[true], curr, end, res);
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of words that are subanagrams of 'w'.
+  //////////////////////////////////////////////////////////////////////////////
+  size_t
+  count_subanagrams_of(const T &w) const
+  {
+    size_t res = 0u;
+    for (const size_t i : shards_of_subanagrams(w)) {
+      res += m_shards[i].count_subanagrams_of(w);
+    }
+    return res;
   }
 
-public:
   //////////////////////////////////////////////////////////////////////////////
   /// \brief Whether the Anatree includes the word 'w'.
   //////////////////////////////////////////////////////////////////////////////
   bool
   contains(const T &w) const
   {
-    const node_ptr &n = find_node(w);
-    return n && n->m_words.contains(w);
+    return m_shards[shard_of(w)].contains(w);
   }
 
-public:
   //////////////////////////////////////////////////////////////////////////////
-  /// \brief Number of stored words.
+  /// \brief Number of words stored in all shards.
   //////////////////////////////////////////////////////////////////////////////
   size_t
   size() const
   {
-    return m_size;
+    size_t res = 0u;
+    for (const anatree_type &a : m_shards) { res += a.size(); }
+    return res;
   }
 
-public:
   //////////////////////////////////////////////////////////////////////////////
-  /// \brief Whether the Anatree is empty.
+  /// \brief Whether all shards are empty.
   //////////////////////////////////////////////////////////////////////////////
   bool
   empty() const
@@ -602,61 +5739,280 @@ public:
 
 public:
   //////////////////////////////////////////////////////////////////////////////
-  /// \brief Number of nodes within the tree.
+  /// \brief Freeze the `i`th shard, e.g. to query it elsewhere.
   //////////////////////////////////////////////////////////////////////////////
-  size_t
-  tree_size() const
+  frozen_type
+  freeze(const size_t i) const
   {
-    return m_tree_size;
+    return shard(i).freeze();
   }
 
-private:
   //////////////////////////////////////////////////////////////////////////////
-  /// \brief Creates a copy of the word 'w' with its characters sorted.
+  /// \brief Write the `i`th shard (frozen) to the file at `path`, such that it
+  ///        can be loaded with `frozen_anatree<...>::load(...)` or
+  ///        `frozen_anatree<...>::load_mmap(...)`.
+  ///
+  /// \throws std::runtime_error if the file cannot be written.
   //////////////////////////////////////////////////////////////////////////////
-  T sorted_word(const T &w) const
+  void
+  save(const size_t i, const std::string &path) const
+  requires std::is_trivially_copyable_v<value_type>
   {
-    T ret(w);
-    std::sort(ret.begin(), ret.end(), m_char_comp);
-    return ret;
+    freeze(i).save(path);
   }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Bounded cache of the results of `subanagrams_of` for repeatedly
+///        asked queries, e.g. the same racks arriving over and over.
+///
+/// \details Results are cached by the key of the query, i.e. its characters
+///          sorted (and without characters in none of the words). Hence, all
+///          anagrams of a query share a single entry. Each entry records the
+///          `anatree<...>::epoch()` it was computed for. After the Anatree
+///          has been changed, its entries are outdated and are recomputed, when
+///          they are asked for again (or evicted like any other entry). The
+///          same cache may thus be used with each new snapshot of a
+///          `concurrent_anatree<...>`.
+///
+///          Entries are split into independent stripes by the hash of their key,
+///          each with its own lock. Hence, concurrent readers only contend if
+///          they ask for keys within the same stripe. Within each stripe, the
+///          CLOCK algorithm evicts an entry that has not been asked for since
+///          the hand last passed it. Results are shared rather than copied.
+///          The search itself happens outside of the lock.
+///
+///          Hits and misses are counted in `anatree<...>::query_stats()`.
+///
+/// \remark The results of different Anatrees should only be cached together,
+///         if they are copies of each other.
+///
+/// \tparam T       Type for words, i.e. lists of elemnts.
+///
+/// \tparam Compare Ordering of the symbols within each word.
+///
+/// \tparam Set     Type to be used for returning sets of words.
+////////////////////////////////////////////////////////////////////////////////
+template<typename T       = std::string,
+         typename Compare = std::less<typename T::value_type>,
+         typename Set     = std::unordered_set<T>>
+class query_cache
+{
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Type of the Anatree queried.
+  //////////////////////////////////////////////////////////////////////////////
+  using anatree_type = anatree<T, Compare, Set>;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Shared ownership of a cached (immutable) result.
+  //////////////////////////////////////////////////////////////////////////////
+  using result_type = std::shared_ptr<const Set>;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of stripes, unless specified otherwise.
+  //////////////////////////////////////////////////////////////////////////////
+  static constexpr size_t default_stripes = 16u;
+
+private:
+  using view_type = typename anatree_type::view_type;
+  using key_type  = typename anatree_type::key_type;
+
+  struct entry
+  {
+    T key;
+    uint64_t epoch;
+    result_type result;
+    bool referenced;
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Independently locked part of the cache.
+  //////////////////////////////////////////////////////////////////////////////
+  struct stripe
+  {
+    mutable std::mutex mutex;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Entries in the order they were created (at most `m_stripe_capacity`).
+    ////////////////////////////////////////////////////////////////////////////
+    std::vector<entry> entries;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Index of each key within `entries`.
+    ////////////////////////////////////////////////////////////////////////////
+    std::unordered_map<T, size_t> index;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Position of the CLOCK hand within `entries`.
+    ////////////////////////////////////////////////////////////////////////////
+    size_t hand = 0u;
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Maximum number of entries per stripe.
+  //////////////////////////////////////////////////////////////////////////////
+  size_t m_stripe_capacity;
 
+  std::vector<stripe> m_stripes;
+
+public:
   //////////////////////////////////////////////////////////////////////////////
-  /// \brief Traverses the anatree in search of the node corresponding to `w`.
+  /// \brief Constructor of an empty cache for (about) `capacity` results.
   ///
-  /// \returns Immutable reference to the node in the tree. If there is none,
-  ///          then it returns `m_null`.
-  /////////////////////////////////////////////////////////////////////////////
-  const node_ptr& find_node(const T w) const
+  /// \details If `capacity` is not a multiple of the number of stripes, it is
+  ///          rounded up. If it is zero, then nothing is cached.
+  ///
+  /// \throws std::invalid_argument if `stripes` is zero.
+  //////////////////////////////////////////////////////////////////////////////
+  explicit
+  query_cache(const size_t capacity, const size_t stripes = default_stripes)
+    : m_stripe_capacity(stripes == 0u ? 0u : (capacity + stripes - 1u) / stripes),
+      m_stripes(stripes)
   {
-    T key = sorted_word(w);
-    return find_node__rec(m_root, key.begin(), key.end());
+    if (stripes == 0u) {
+      throw std::invalid_argument("query_cache: at least one stripe is required");
+    }
   }
 
-  const node_ptr& find_node__rec(const node_ptr &p,
-                                 typename T::iterator curr,
-                                 const typename T::iterator end) const
+  query_cache(const query_cache&) = delete;
+  query_cache& operator=(const query_cache&) = delete;
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Obtain all words in `a` that are subanagrams of 'w', reusing the
+  ///        result of an earlier query with the same key on the same version
+  ///        of `a`.
+  //////////////////////////////////////////////////////////////////////////////
+  result_type
+  subanagrams_of(const anatree_type &a, const T &w)
   {
-    // Case: Iterator is done
-    if (curr == end) {
-      return p;
+    const key_type key = a.subanagram_key(w);
+    return subanagrams_of__key(a, key);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Obtain all words in `a` that are subanagrams of 'w', reusing the
+  ///        result of an earlier query with the same key on the same version
+  ///        of `a`.
+  //////////////////////////////////////////////////////////////////////////////
+  template<std::same_as<view_type> V>
+  result_type
+  subanagrams_of(const anatree_type &a, const V w)
+  {
+    const key_type key = a.subanagram_key(w);
+    return subanagrams_of__key(a, key);
+  }
+
+private:
+  result_type
+  subanagrams_of__key(const anatree_type &a, const key_type &key)
+  {
+    const uint64_t epoch = a.epoch();
+
+    T k(key.begin(), key.end());
+    stripe &s = m_stripes[std::hash<T>{}(k) % m_stripes.size()];
+
+    // Case: Cached for this version of the Anatree
+    // -> Share the earlier result
+    {
+      const std::lock_guard<std::mutex> lock(s.mutex);
+
+      const auto it = s.index.find(k);
+      if (it != s.index.end() && s.entries[it->second].epoch == epoch) {
+        ANATREE_COUNT(cache_hits, 1u);
+        entry &e = s.entries[it->second];
+        e.referenced = true;
+        return e.result;
+      }
     }
 
-    // Case: Iterator behind or tree is done
-    // -> No words with all letters exist, return Ø .
-    if (m_char_comp(*curr, p->m_char) || p->m_char == node::NIL) {
-      return m_null;
+    // Case: Missing or outdated
+    // -> Search the Anatree (without holding the lock) and cache the result
+    ANATREE_COUNT(cache_misses, 1u);
+
+    auto res = std::make_shared<Set>();
+    const auto f = anatree_type::insert_into(*res);
+    a.subanagrams_of__iter(key, anatree_type::word_visitor(f));
+
+    if (m_stripe_capacity == 0u) { return res; }
+
+    const std::lock_guard<std::mutex> lock(s.mutex);
+
+    // Case: Added by another thread in the meantime (or outdated)
+    // -> Replace it
+    const auto it = s.index.find(k);
+    if (it != s.index.end()) {
+      entry &e = s.entries[it->second];
+      if (e.epoch <= epoch) {
+        e.epoch  = epoch;
+        e.result = res;
+      }
+      e.referenced = true;
+      return res;
     }
 
-    // Case: Iterator ahead
-    // -> Follow 'false' child
-    if (m_char_comp(p->m_char, *curr)) {
-      return find_node__rec(p->m_children[false], curr, end);
+    // Case: Stripe not yet full
+    // -> Add a new entry
+    if (s.entries.size() < m_stripe_capacity) {
+      s.index.emplace(k, s.entries.size());
+      s.entries.push_back({ std::move(k), epoch, res, false });
+      return res;
     }
 
-    // Case: Iterator and node matches
-    // -> Follow 'true' child
-    return find_node__rec(p->m_children[true], ++curr, end);
+    // Case: Stripe is full
+    // -> Advance the hand to an entry that has not been referenced since it
+    //    last passed it and replace that one.
+    while (s.entries[s.hand].referenced) {
+      s.entries[s.hand].referenced = false;
+      s.hand = (s.hand + 1u) % s.entries.size();
+    }
+
+    entry &e = s.entries[s.hand];
+    s.index.erase(e.key);
+    s.index.emplace(k, s.hand);
+    e = { std::move(k), epoch, res, false };
+
+    s.hand = (s.hand + 1u) % s.entries.size();
+    return res;
+  }
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Remove all entries.
+  //////////////////////////////////////////////////////////////////////////////
+  void
+  clear()
+  {
+    for (stripe &s : m_stripes) {
+      const std::lock_guard<std::mutex> lock(s.mutex);
+      s.entries.clear();
+      s.index.clear();
+      s.hand = 0u;
+    }
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Number of entries (including outdated ones).
+  //////////////////////////////////////////////////////////////////////////////
+  size_t
+  size() const
+  {
+    size_t res = 0u;
+    for (const stripe &s : m_stripes) {
+      const std::lock_guard<std::mutex> lock(s.mutex);
+      res += s.entries.size();
+    }
+    return res;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Maximum number of entries.
+  //////////////////////////////////////////////////////////////////////////////
+  size_t
+  capacity() const
+  {
+    return m_stripe_capacity * m_stripes.size();
   }
 };
 
@@ -0,0 +1,349 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <anatree.h>
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Benchmarks of the Anatree on word lists and on synthetic corpora.
+///
+/// \details Usage: `anatree_bench [--quick] [<word list> ...]`
+///
+///          Each word list is a file with one word per line. Additionally, an
+///          English-like and a large-alphabet synthetic corpus are generated.
+///          All results are printed to standard output as a single JSON
+///          object, such that they can be tracked across releases.
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+  using clock_type = std::chrono::steady_clock;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Settings for the entire run.
+  //////////////////////////////////////////////////////////////////////////////
+  struct config
+  {
+    size_t synthetic_words = 200000u;
+    size_t queries         = 20000u;
+    size_t rack_queries    = 2000u;
+    std::vector<size_t> rack_lengths = { 7u, 10u, 15u };
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Milliseconds since `start`.
+  //////////////////////////////////////////////////////////////////////////////
+  double
+  ms_since(const clock_type::time_point start)
+  {
+    return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Sink for query results, such that no query is optimised away.
+  //////////////////////////////////////////////////////////////////////////////
+  size_t checksum = 0u;
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Writer of one JSON object per corpus.
+  //////////////////////////////////////////////////////////////////////////////
+  class json_object
+  {
+    std::ostream &m_out;
+    bool m_first = true;
+
+  public:
+    json_object(std::ostream &out)
+      : m_out(out)
+    {
+      m_out << "{";
+    }
+
+    ~json_object()
+    {
+      m_out << "\n    }";
+    }
+
+    template<typename V>
+    void
+    field(const std::string &key, const V &v)
+    {
+      m_out << (m_first ? "" : ",") << "\n      \"" << key << "\": ";
+      m_first = false;
+
+      if constexpr (std::is_convertible_v<V, std::string>) {
+        m_out << "\"";
+        for (const char c : std::string(v)) {
+          if (c == '"' || c == '\\') { m_out << '\\'; }
+          m_out << c;
+        }
+        m_out << "\"";
+      } else {
+        m_out << v;
+      }
+    }
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Latency (in nanoseconds) and throughput (in queries per second) of
+  ///        `f` on each of the given queries.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename Q, typename F>
+  void
+  measure(json_object &out, const std::string &name, const std::vector<Q> &queries, F &&f)
+  {
+    const auto start = clock_type::now();
+    for (const Q &q : queries) { checksum += f(q); }
+    const double ms = ms_since(start);
+
+    const double ns_per_query = queries.empty() ? 0.0 : (ms * 1e6) / queries.size();
+    const double throughput   = ms == 0.0 ? 0.0 : (queries.size() * 1e3) / ms;
+
+    out.field(name + "_ns", ns_per_query);
+    out.field(name + "_per_s", throughput);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Random racks of `length` characters, drawn with the frequency of
+  ///        the characters within `words`.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename T>
+  std::vector<T>
+  racks_of(const std::vector<T> &words, const size_t length, const size_t n, std::mt19937 &rng)
+  {
+    std::vector<typename T::value_type> chars;
+    for (const T &w : words) { chars.insert(chars.end(), w.begin(), w.end()); }
+
+    std::vector<T> res;
+    if (chars.empty()) { return res; }
+
+    std::uniform_int_distribution<size_t> pick(0u, chars.size() - 1u);
+    for (size_t i = 0u; i < n; ++i) {
+      T rack;
+      for (size_t j = 0u; j < length; ++j) { rack.push_back(chars[pick(rng)]); }
+      res.push_back(std::move(rack));
+    }
+    return res;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Run all benchmarks on a corpus of words.
+  //////////////////////////////////////////////////////////////////////////////
+  template<typename T>
+  void
+  bench(std::ostream &os, const std::string &name, const std::vector<T> &words, const config &c)
+  {
+    std::mt19937 rng(42);
+    json_object out(os);
+
+    out.field("corpus", name);
+    out.field("words", words.size());
+
+    // Building
+    {
+      const auto start = clock_type::now();
+      const anatree<T> a(words.begin(), words.end());
+      out.field("build_ms", ms_since(start));
+      checksum += a.size();
+    }
+
+    // Merging two halves, e.g. after building them in parallel
+    {
+      const auto mid = words.begin() + words.size() / 2u;
+      anatree<T> lo(words.begin(), mid);
+      anatree<T> hi(mid, words.end());
+
+      const auto start = clock_type::now();
+      lo |= std::move(hi);
+      out.field("merge_ms", ms_since(start));
+      checksum += lo.size();
+    }
+
+    anatree<T> a;
+    {
+      const auto start = clock_type::now();
+      for (const T &w : words) { a.insert(w); }
+      const double ms = ms_since(start);
+      out.field("insert_ms", ms);
+      out.field("insert_ns", words.empty() ? 0.0 : (ms * 1e6) / words.size());
+    }
+
+    out.field("size", a.size());
+    out.field("tree_size", a.tree_size());
+    out.field("concrete_tree_size", a.concrete_tree_size());
+
+    {
+      const auto start = clock_type::now();
+      const frozen_anatree<T> f = a.freeze();
+      out.field("freeze_ms", ms_since(start));
+      out.field("frozen_dag_size", f.dag_size());
+      out.field("frozen_bytes", f.memory_size());
+      out.field("frozen_bytes_per_word", a.empty() ? 0.0 : double(f.memory_size()) / a.size());
+    }
+
+    // Queries on words (and shuffles of them)
+    std::vector<T> hits;
+    std::vector<T> shuffles;
+    if (!words.empty()) {
+      std::uniform_int_distribution<size_t> pick(0u, words.size() - 1u);
+      for (size_t i = 0u; i < c.queries; ++i) {
+        T w = words[pick(rng)];
+        hits.push_back(w);
+        std::shuffle(w.begin(), w.end(), rng);
+        shuffles.push_back(std::move(w));
+      }
+    }
+
+    measure(out, "contains", hits, [&a](const T &w) { return a.contains(w); });
+    measure(out, "anagrams_of", shuffles, [&a](const T &w) { return a.anagrams_of(w).size(); });
+
+    // Queries on random racks
+    for (const size_t l : c.rack_lengths) {
+      const std::vector<T> racks = racks_of(words, l, c.rack_queries, rng);
+      const std::string suffix = "_" + std::to_string(l);
+
+      measure(out, "subanagrams_of" + suffix, racks,
+              [&a](const T &w) { return a.subanagrams_of(w).size(); });
+      measure(out, "count_subanagrams_of" + suffix, racks,
+              [&a](const T &w) { return a.count_subanagrams_of(w); });
+
+      // Every rack asked twice, i.e. half of the queries hit the cache.
+      std::vector<T> repeated = racks;
+      repeated.insert(repeated.end(), racks.begin(), racks.end());
+
+      query_cache<T> cache(repeated.size());
+      measure(out, "cached_subanagrams_of" + suffix, repeated,
+              [&a, &cache](const T &w) { return cache.subanagrams_of(a, w)->size(); });
+    }
+
+    // Maximal words
+    {
+      const auto start = clock_type::now();
+      const auto res = a.keys();
+      out.field("keys_ms", ms_since(start));
+      out.field("keys", res.size());
+    }
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Words with the length and letter frequencies of English.
+  //////////////////////////////////////////////////////////////////////////////
+  std::vector<std::string>
+  synthetic_english(const size_t n)
+  {
+    // Relative frequency (in per mille) of 'a' to 'z' within English words.
+    constexpr int frequency[26] = { 78, 20, 40, 38, 110, 14, 30, 23, 82, 2, 25, 53, 27,
+                                    72, 61, 28, 2, 73, 87, 67, 33, 10, 9, 3, 16, 4 };
+
+    std::mt19937 rng(1);
+    std::discrete_distribution<int> letter(std::begin(frequency), std::end(frequency));
+    std::binomial_distribution<size_t> length(16u, 0.5);
+
+    std::vector<std::string> res;
+    res.reserve(n);
+    for (size_t i = 0u; i < n; ++i) {
+      std::string w;
+      const size_t l = std::max<size_t>(2u, length(rng));
+      for (size_t j = 0u; j < l; ++j) { w.push_back('a' + letter(rng)); }
+      res.push_back(std::move(w));
+    }
+    return res;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Words over an alphabet of `alphabet_size` (Zipf distributed)
+  ///        symbols, e.g. for syllables or logograms.
+  //////////////////////////////////////////////////////////////////////////////
+  std::vector<std::u32string>
+  synthetic_alphabet(const size_t n, const size_t alphabet_size)
+  {
+    std::vector<double> weights;
+    for (size_t i = 1u; i <= alphabet_size; ++i) { weights.push_back(1.0 / i); }
+
+    std::mt19937 rng(2);
+    std::discrete_distribution<size_t> symbol(weights.begin(), weights.end());
+    std::uniform_int_distribution<size_t> length(1u, 6u);
+
+    std::vector<std::u32string> res;
+    res.reserve(n);
+    for (size_t i = 0u; i < n; ++i) {
+      std::u32string w;
+      const size_t l = length(rng);
+      for (size_t j = 0u; j < l; ++j) { w.push_back(char32_t(0x4E00u + symbol(rng))); }
+      res.push_back(std::move(w));
+    }
+    return res;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  /// \brief Read a word list with one word per line.
+  //////////////////////////////////////////////////////////////////////////////
+  std::vector<std::string>
+  read_words(const std::string &path)
+  {
+    std::ifstream in(path);
+    if (!in) { throw std::runtime_error("Cannot open '" + path + "'"); }
+
+    std::vector<std::string> res;
+    std::string line;
+    while (std::getline(in, line)) {
+      if (!line.empty() && line.back() == '\r') { line.pop_back(); }
+      if (!line.empty()) { res.push_back(std::move(line)); }
+    }
+    return res;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  config c;
+  std::vector<std::string> paths;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    if (arg == "--quick") {
+      c.synthetic_words = 20000u;
+      c.queries         = 2000u;
+      c.rack_queries    = 200u;
+    } else {
+      paths.push_back(std::string(arg));
+    }
+  }
+
+  std::ostringstream os;
+  os << "{\n  \"corpora\": [";
+
+  bool first = true;
+  const auto next = [&]() {
+    os << (first ? "" : ",") << "\n    ";
+    first = false;
+  };
+
+  try {
+    for (const std::string &path : paths) {
+      next();
+      bench(os, path, read_words(path), c);
+    }
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  next();
+  bench(os, "synthetic-english", synthetic_english(c.synthetic_words), c);
+
+  next();
+  bench(os, "synthetic-alphabet-4096", synthetic_alphabet(c.synthetic_words / 2u, 4096u), c);
+
+  os << "\n  ],\n  \"checksum\": " << checksum << "\n}\n";
+  std::cout << os.str();
+  return 0;
+}
@@ -1,3 +1,9 @@
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <ranges>
+#include <string_view>
+#include <thread>
 #include <vector>
 
 // Import Unit Testing framework, Bandit
@@ -149,6 +155,117 @@ go_bandit([]() {
       });
     });
 
+    // -------------------------------------------------------------------------
+    describe("insert(w), concrete_tree_size()", []() {
+      it("has no concrete nodes for Ø", []() {
+        anatree<> a;
+        AssertThat(a.concrete_tree_size(), Is().EqualTo(0u));
+      });
+
+      it("has one concrete node for { '' }", []() {
+        anatree<> a;
+        a.insert("");
+        AssertThat(a.concrete_tree_size(), Is().EqualTo(1u));
+      });
+
+      it("shares the NIL leaf for { 'a' }", []() {
+        anatree<> a;
+        a.insert("a");
+
+        AssertThat(a.tree_size(), Is().EqualTo(3u));
+        AssertThat(a.concrete_tree_size(), Is().EqualTo(2u));
+      });
+
+      it("shares the NIL leaves for { 'a', 'b' }", []() {
+        anatree<> a;
+        a.insert("a");
+        a.insert("b");
+
+        AssertThat(a.tree_size(), Is().EqualTo(5u));
+        AssertThat(a.concrete_tree_size(), Is().EqualTo(4u));
+      });
+
+      it("shares the NIL leaves for { 'abc', 'bc' }", []() {
+        anatree<> a;
+        a.insert("bc");
+        a.insert("abc");
+
+        AssertThat(a.tree_size(), Is().EqualTo(11u));
+        AssertThat(a.concrete_tree_size(), Is().EqualTo(7u));
+      });
+
+      it("has no concrete nodes after clear()", []() {
+        anatree<> a;
+        a.insert("ab");
+        a.clear();
+
+        AssertThat(a.concrete_tree_size(), Is().EqualTo(0u));
+      });
+    });
+
+    // -------------------------------------------------------------------------
+    describe("insert(w), memory_usage(), query_stats()", []() {
+      anatree<> a;
+      a.insert("do");
+      a.insert("dog");
+      a.insert("god");
+      a.insert("gold");
+
+      it("has no nodes or sets in Ø", []() {
+        anatree<> b;
+        const memory_stats m = b.memory_usage();
+
+        AssertThat(m.internal_nodes, Is().EqualTo(0u));
+        AssertThat(m.nil_nodes, Is().EqualTo(0u));
+        AssertThat(m.word_sets, Is().EqualTo(0u));
+      });
+
+      it("splits the concrete nodes into internal and NIL nodes", [&]() {
+        const memory_stats m = a.memory_usage();
+
+        AssertThat(m.internal_nodes + m.nil_nodes, Is().EqualTo(a.concrete_tree_size()));
+        AssertThat(0u < m.internal_nodes, Is().True());
+        AssertThat(0u < m.nil_nodes, Is().True());
+        AssertThat(m.free_nodes, Is().EqualTo(0u));
+      });
+
+      it("accounts for the nodes and the words", [&]() {
+        const memory_stats m = a.memory_usage();
+
+        AssertThat(m.word_sets, Is().EqualTo(3u));
+        AssertThat(0u < m.node_bytes, Is().True());
+        AssertThat(a.size() * sizeof(std::string) <= m.set_bytes, Is().True());
+      });
+
+      it("counts released nodes after erase(w)", [&]() {
+        anatree<> b(a);
+        b.erase("gold");
+
+        const memory_stats m = b.memory_usage();
+        AssertThat(0u < m.free_nodes, Is().True());
+        AssertThat(m.internal_nodes + m.nil_nodes, Is().EqualTo(b.concrete_tree_size()));
+      });
+
+      it("counts the work of a query (if instrumented)", [&]() {
+        anatree<>::reset_query_stats();
+        const auto res = a.subanagrams_of("gold");
+        const traversal_stats s = anatree<>::query_stats();
+
+        if (anatree<>::has_query_stats) {
+          AssertThat(0u < s.nodes_visited, Is().True());
+          AssertThat(0u < s.true_edges, Is().True());
+          AssertThat(s.words_copied, Is().EqualTo(res.size()));
+          AssertThat(s.sorted_keys, Is().EqualTo(1u));
+        } else {
+          AssertThat(s.nodes_visited, Is().EqualTo(0u));
+          AssertThat(s.words_copied, Is().EqualTo(0u));
+        }
+
+        anatree<>::reset_query_stats();
+        AssertThat(anatree<>::query_stats().nodes_visited, Is().EqualTo(0u));
+      });
+    });
+
     // -------------------------------------------------------------------------
     describe("anatree(...)", []() {
       it("can create a new and empty tree", []() {
@@ -196,6 +313,59 @@ go_bandit([]() {
         AssertThat(a1.contains("a"), Is().False());
       });
 
+      it("shares the pages of a copy until they are changed", []() {
+        anatree<> a1;
+        for (size_t i = 0u; i < 1000u; ++i) { a1.insert(std::to_string(i)); }
+        AssertThat(a1.memory_usage().shared_pages, Is().EqualTo(0u));
+
+        anatree<> a2(a1);
+        const size_t shared_pages = a1.memory_usage().shared_pages;
+        AssertThat(0u < shared_pages, Is().True());
+        AssertThat(a2.memory_usage().shared_pages, Is().EqualTo(shared_pages));
+
+        a2.insert("12345");
+        a2.erase("999");
+
+        // Only the pages on the paths of '12345' and '999' are duplicated.
+        const size_t still_shared = a2.memory_usage().shared_pages;
+        AssertThat(0u < still_shared, Is().True());
+        AssertThat(still_shared < shared_pages, Is().True());
+        AssertThat(a1.memory_usage().shared_pages, Is().EqualTo(still_shared));
+
+        AssertThat(a1.size(), Is().EqualTo(1000u));
+        AssertThat(a1.contains("999"), Is().True());
+        AssertThat(a1.contains("12345"), Is().False());
+
+        AssertThat(a2.size(), Is().EqualTo(1000u));
+        AssertThat(a2.contains("999"), Is().False());
+        AssertThat(a2.contains("12345"), Is().True());
+        AssertThat(a2.subanagrams_of("54321").size(), Is().EqualTo(a1.subanagrams_of("54321").size() + 1u));
+      });
+
+      it("can shrink_to_fit() a copy without changing the original", []() {
+        anatree<> a1;
+        for (size_t i = 0u; i < 1000u; ++i) { a1.insert(std::to_string(i)); }
+
+        anatree<> a2(a1);
+        for (size_t i = 0u; i < 1000u; i += 2u) { a2.erase(std::to_string(i)); }
+        a2.shrink_to_fit();
+
+        AssertThat(a1.memory_usage().shared_pages, Is().EqualTo(0u));
+        AssertThat(a2.memory_usage().shared_pages, Is().EqualTo(0u));
+
+        AssertThat(a1.size(), Is().EqualTo(1000u));
+        AssertThat(a2.size(), Is().EqualTo(500u));
+        for (size_t i = 0u; i < 1000u; ++i) {
+          AssertThat(a1.contains(std::to_string(i)), Is().True());
+          AssertThat(a2.contains(std::to_string(i)), Is().EqualTo(i % 2u == 1u));
+        }
+
+        a1.shrink_to_fit();
+        AssertThat(a1.size(), Is().EqualTo(1000u));
+        AssertThat(a1.subanagrams_of("9876") == anatree<>(a1).subanagrams_of("9876"), Is().True());
+        AssertThat(a2.contains("999"), Is().True());
+      });
+
       it("can move-construct an empty Anatree", []() {
         const auto a1_gen = []() {
           anatree<> a1;
@@ -269,6 +439,319 @@ go_bandit([]() {
 
         AssertThat(a.tree_size(), Is().EqualTo(11u));
       });
+
+      it("can iterator-construct from { 'dog', 'god', 'do', 'dog', 'gold', '' }", []() {
+        std::vector<std::string> inputs = { "dog", "god", "do", "dog", "gold", "" };
+
+        anatree<> a(inputs.begin(), inputs.end());
+
+        anatree<> b;
+        for (const std::string &w : inputs) { b.insert(w); }
+
+        AssertThat(a.size(), Is().EqualTo(5u));
+        AssertThat(a.tree_size(), Is().EqualTo(b.tree_size()));
+        AssertThat(a.concrete_tree_size(), Is().EqualTo(b.concrete_tree_size()));
+
+        AssertThat(a.contains(""), Is().True());
+        AssertThat(a.contains("do"), Is().True());
+        AssertThat(a.contains("dog"), Is().True());
+        AssertThat(a.contains("god"), Is().True());
+        AssertThat(a.contains("gold"), Is().True());
+        AssertThat(a.contains("go"), Is().False());
+
+        AssertThat(a.subanagrams_of("goldy") == b.subanagrams_of("goldy"), Is().True());
+      });
+    });
+
+    // -------------------------------------------------------------------------
+    describe("clear()", []() {
+      it("can clear Ø", []() {
+        anatree<> a;
+        a.clear();
+
+        AssertThat(a.size(), Is().EqualTo(0u));
+        AssertThat(a.empty(), Is().True());
+
+        AssertThat(a.tree_size(), Is().EqualTo(1u));
+      });
+
+      it("can clear { '', 'ab', 'b' }", []() {
+        anatree<> a;
+        a.insert("b");
+        a.insert("");
+        a.insert("ab");
+        a.clear();
+
+        AssertThat(a.size(), Is().EqualTo(0u));
+        AssertThat(a.empty(), Is().True());
+
+        AssertThat(a.tree_size(), Is().EqualTo(1u));
+
+        AssertThat(a.contains(""), Is().False());
+        AssertThat(a.contains("b"), Is().False());
+        AssertThat(a.contains("ab"), Is().False());
+      });
+
+      it("can insert { 'a', 'ba' } after having cleared { 'b', 'c' }", []() {
+        anatree<> a;
+        a.insert("b");
+        a.insert("c");
+        a.clear();
+
+        a.insert("a");
+        a.insert("ba");
+
+        AssertThat(a.size(), Is().EqualTo(2u));
+        AssertThat(a.tree_size(), Is().EqualTo(5u));
+
+        AssertThat(a.contains("a"), Is().True());
+        AssertThat(a.contains("ba"), Is().True());
+        AssertThat(a.contains("b"), Is().False());
+        AssertThat(a.contains("c"), Is().False());
+      });
+    });
+
+    // -------------------------------------------------------------------------
+    describe("erase(w), shrink_to_fit()", []() {
+      it("erases nothing from Ø", []() {
+        anatree<> a;
+        AssertThat(a.erase("a"), Is().EqualTo(0u));
+
+        AssertThat(a.size(), Is().EqualTo(0u));
+        AssertThat(a.tree_size(), Is().EqualTo(1u));
+      });
+
+      it("erases nothing for words that are not in { 'ab' }", []() {
+        anatree<> a;
+        a.insert("ab");
+
+        AssertThat(a.erase(""), Is().EqualTo(0u));
+        AssertThat(a.erase("a"), Is().EqualTo(0u));
+        AssertThat(a.erase("ba"), Is().EqualTo(0u));
+        AssertThat(a.erase("abc"), Is().EqualTo(0u));
+
+        AssertThat(a.size(), Is().EqualTo(1u));
+        AssertThat(a.contains("ab"), Is().True());
+      });
+
+      it("can erase 'a' from { 'a' }", []() {
+        anatree<> a;
+        a.insert("a");
+
+        AssertThat(a.erase("a"), Is().EqualTo(1u));
+        AssertThat(a.erase("a"), Is().EqualTo(0u));
+
+        AssertThat(a.size(), Is().EqualTo(0u));
+        AssertThat(a.empty(), Is().True());
+        AssertThat(a.tree_size(), Is().EqualTo(1u));
+        AssertThat(a.concrete_tree_size(), Is().EqualTo(0u));
+        AssertThat(a.contains("a"), Is().False());
+      });
+
+      it("can erase 'ab' from { 'a', 'ab' }", []() {
+        anatree<> a;
+        a.insert("a");
+        a.insert("ab");
+
+        AssertThat(a.erase("ab"), Is().EqualTo(1u));
+
+        AssertThat(a.size(), Is().EqualTo(1u));
+        AssertThat(a.tree_size(), Is().EqualTo(3u));
+        AssertThat(a.concrete_tree_size(), Is().EqualTo(2u));
+        AssertThat(a.contains("a"), Is().True());
+        AssertThat(a.contains("ab"), Is().False());
+      });
+
+      it("can erase 'a' from { 'a', 'b' }", []() {
+        anatree<> a;
+        a.insert("a");
+        a.insert("b");
+
+        AssertThat(a.erase("a"), Is().EqualTo(1u));
+
+        AssertThat(a.size(), Is().EqualTo(1u));
+        AssertThat(a.tree_size(), Is().EqualTo(3u));
+        AssertThat(a.concrete_tree_size(), Is().EqualTo(2u));
+        AssertThat(a.contains("b"), Is().True());
+        AssertThat(a.has_anagram_of("a"), Is().False());
+      });
+
+      it("can erase one of the anagrams 'dog' and 'god'", []() {
+        anatree<> a;
+        a.insert("dog");
+        a.insert("god");
+
+        const size_t tree_size = a.tree_size();
+        AssertThat(a.erase("god"), Is().EqualTo(1u));
+
+        AssertThat(a.size(), Is().EqualTo(1u));
+        AssertThat(a.tree_size(), Is().EqualTo(tree_size));
+        AssertThat(a.contains("dog"), Is().True());
+        AssertThat(a.contains("god"), Is().False());
+      });
+
+      it("results in the same tree as never inserting the word", []() {
+        const std::vector<std::string> ws = { "", "a", "ab", "abc", "b", "ba", "bc", "c", "dog", "god" };
+
+        for (const auto &w : ws) {
+          anatree<> a(ws.begin(), ws.end());
+          AssertThat(a.erase(w), Is().EqualTo(1u));
+
+          anatree<> b;
+          for (const auto &v : ws) {
+            if (v != w) { b.insert(v); }
+          }
+
+          AssertThat(a.size(), Is().EqualTo(b.size()));
+          AssertThat(a.tree_size(), Is().EqualTo(b.tree_size()));
+          AssertThat(a.concrete_tree_size(), Is().EqualTo(b.concrete_tree_size()));
+          AssertThat(a.keys() == b.keys(), Is().True());
+          AssertThat(a.subanagrams_of("abcdgo") == b.subanagrams_of("abcdgo"), Is().True());
+          AssertThat(a.count_subanagrams_of("abcdgo"), Is().EqualTo(b.count_subanagrams_of("abcdgo")));
+        }
+      });
+
+      it("can erase a range of words", []() {
+        const std::vector<std::string> ws = { "a", "ab", "b", "ba" };
+        anatree<> a(ws.begin(), ws.end());
+        a.insert("c");
+
+        AssertThat(a.erase(ws.begin(), ws.end()), Is().EqualTo(4u));
+
+        AssertThat(a.size(), Is().EqualTo(1u));
+        AssertThat(a.contains("c"), Is().True());
+      });
+
+      it("can insert words again after erasing them", []() {
+        anatree<> a;
+        a.insert("ab");
+        a.insert("b");
+        a.erase("ab");
+        a.insert("ab");
+        a.insert("abc");
+
+        AssertThat(a.size(), Is().EqualTo(3u));
+        AssertThat(a.contains("ab"), Is().True());
+        AssertThat(a.contains("abc"), Is().True());
+        AssertThat(a.subanagrams_of("abc").size(), Is().EqualTo(3u));
+      });
+
+      it("releases nodes when erasing most words", []() {
+        std::vector<std::string> ws;
+        for (char a = 'a'; a <= 'z'; ++a) {
+          for (char b = 'a'; b <= 'z'; ++b) { ws.push_back(std::string{ a, b, 'z' }); }
+        }
+
+        anatree<> a(ws.begin(), ws.end());
+        const size_t concrete_tree_size = a.concrete_tree_size();
+
+        a.erase(ws.begin() + 1, ws.end());
+        AssertThat(a.size(), Is().EqualTo(1u));
+        AssertThat(a.concrete_tree_size() < concrete_tree_size / 10u, Is().True());
+
+        a.shrink_to_fit();
+        AssertThat(a.size(), Is().EqualTo(1u));
+        AssertThat(a.contains(ws[0]), Is().True());
+        AssertThat(a.subanagrams_of(ws[0]).size(), Is().EqualTo(1u));
+      });
+    });
+
+    // -------------------------------------------------------------------------
+    describe("merge(a), operator|=, operator-=, operator&=", []() {
+      const std::vector<std::string> ws_1 = { "", "do", "dog", "gold", "loo", "of" };
+      const std::vector<std::string> ws_2 = { "do", "fog", "god", "odd", "oo", "of" };
+
+      std::vector<std::string> ws_all = ws_1;
+      ws_all.insert(ws_all.end(), ws_2.begin(), ws_2.end());
+
+      it("can merge Ø into Ø", []() {
+        anatree<> a;
+        a.merge(anatree<>());
+
+        AssertThat(a.size(), Is().EqualTo(0u));
+        AssertThat(a.tree_size(), Is().EqualTo(1u));
+      });
+
+      it("can merge into Ø", [&]() {
+        anatree<> a;
+        anatree<> b(ws_1.begin(), ws_1.end());
+        a.merge(std::move(b));
+
+        AssertThat(b.empty(), Is().True());
+        AssertThat(a.size(), Is().EqualTo(ws_1.size()));
+        AssertThat(a.tree_size(), Is().EqualTo(anatree<>(ws_1.begin(), ws_1.end()).tree_size()));
+        AssertThat(a.contains("gold"), Is().True());
+      });
+
+      it("is the same as inserting all words", [&]() {
+        anatree<> a(ws_1.begin(), ws_1.end());
+        anatree<> b(ws_2.begin(), ws_2.end());
+        a |= std::move(b);
+
+        const anatree<> expected(ws_all.begin(), ws_all.end());
+        AssertThat(a.size(), Is().EqualTo(expected.size()));
+        AssertThat(a.tree_size(), Is().EqualTo(expected.tree_size()));
+        AssertThat(a.concrete_tree_size(), Is().EqualTo(expected.concrete_tree_size()));
+
+        for (const std::string &w : ws_all) { AssertThat(a.contains(w), Is().True()); }
+        AssertThat(a.subanagrams_of("goldfood") == expected.subanagrams_of("goldfood"), Is().True());
+        AssertThat(a.count_subanagrams_of("dogo"), Is().EqualTo(expected.count_subanagrams_of("dogo")));
+      });
+
+      it("leaves a merged copy unchanged", [&]() {
+        anatree<> a(ws_2.begin(), ws_2.end());
+        const anatree<> b(ws_1.begin(), ws_1.end());
+        a |= b;
+
+        AssertThat(a.size(), Is().EqualTo(anatree<>(ws_all.begin(), ws_all.end()).size()));
+        AssertThat(b.size(), Is().EqualTo(ws_1.size()));
+        AssertThat(b.contains("gold"), Is().True());
+        AssertThat(b.contains("god"), Is().False());
+      });
+
+      it("can still be changed after merging", [&]() {
+        anatree<> a(ws_1.begin(), ws_1.end());
+        a |= anatree<>(ws_2.begin(), ws_2.end());
+
+        a.insert("good");
+        a.erase("gold");
+        AssertThat(a.contains("good"), Is().True());
+        AssertThat(a.contains("gold"), Is().False());
+        AssertThat(a.anagrams_of("odog").size(), Is().EqualTo(1u));
+      });
+
+      it("can remove the words of another tree", [&]() {
+        anatree<> a(ws_1.begin(), ws_1.end());
+        a -= anatree<>(ws_2.begin(), ws_2.end());
+
+        const std::vector<std::string> ws = { "", "dog", "gold", "loo" };
+        const anatree<> expected(ws.begin(), ws.end());
+        AssertThat(a.size(), Is().EqualTo(ws.size()));
+        AssertThat(a.tree_size(), Is().EqualTo(expected.tree_size()));
+        for (const std::string &w : ws) { AssertThat(a.contains(w), Is().True()); }
+        AssertThat(a.contains("do"), Is().False());
+        AssertThat(a.contains("of"), Is().False());
+      });
+
+      it("can keep only the words of another tree", [&]() {
+        anatree<> a(ws_1.begin(), ws_1.end());
+        a &= anatree<>(ws_2.begin(), ws_2.end());
+
+        const std::vector<std::string> ws = { "do", "of" };
+        AssertThat(a.size(), Is().EqualTo(2u));
+        AssertThat(a.tree_size(), Is().EqualTo(anatree<>(ws.begin(), ws.end()).tree_size()));
+        AssertThat(a.contains("do"), Is().True());
+        AssertThat(a.contains("of"), Is().True());
+        AssertThat(a.contains("dog"), Is().False());
+      });
+
+      it("is Ø when keeping only the words of Ø", [&]() {
+        anatree<> a(ws_1.begin(), ws_1.end());
+        a &= anatree<>();
+
+        AssertThat(a.empty(), Is().True());
+        AssertThat(a.tree_size(), Is().EqualTo(1u));
+      });
     });
 
     // -------------------------------------------------------------------------
@@ -792,20 +1275,42 @@ go_bandit([]() {
         AssertThat(res.contains("aba"), Is().True());
       });
 
-      it("can find keys in { 'do', 'dog', 'fog', 'god', 'gold', 'loo', 'odd', 'of', 'oo' }", []() {
+      it("can find keys in { 'abc', 'b' }", []() {
         anatree<> a;
-        a.insert("do");
-        a.insert("dog");
-        a.insert("fog");
-        a.insert("god");
-        a.insert("gold");
-        a.insert("loo");
-        a.insert("odd");
-        a.insert("of");
-        a.insert("oo");
+        a.insert("abc");
+        a.insert("b");
 
         const auto res = a.keys();
-        AssertThat(res.size(), Is().EqualTo(4u));
+        AssertThat(res.size(), Is().EqualTo(1u));
+        AssertThat(res.contains("abc"), Is().True());
+      });
+
+      it("can find keys in { 'ab', 'b', 'bc' }", []() {
+        anatree<> a;
+        a.insert("ab");
+        a.insert("b");
+        a.insert("bc");
+
+        const auto res = a.keys();
+        AssertThat(res.size(), Is().EqualTo(2u));
+        AssertThat(res.contains("ab"), Is().True());
+        AssertThat(res.contains("bc"), Is().True());
+      });
+
+      it("can find keys in { 'do', 'dog', 'fog', 'god', 'gold', 'loo', 'odd', 'of', 'oo' }", []() {
+        anatree<> a;
+        a.insert("do");
+        a.insert("dog");
+        a.insert("fog");
+        a.insert("god");
+        a.insert("gold");
+        a.insert("loo");
+        a.insert("odd");
+        a.insert("of");
+        a.insert("oo");
+
+        const auto res = a.keys();
+        AssertThat(res.size(), Is().EqualTo(4u));
         AssertThat(res.contains("loo"), Is().True());
         AssertThat(res.contains("fog"), Is().True());
         AssertThat(res.contains("gold"), Is().True());
@@ -813,6 +1318,43 @@ go_bandit([]() {
       });
     });
 
+    // -------------------------------------------------------------------------
+    describe("insert(w), keys(f)", []() {
+      anatree<> a;
+      a.insert("do");
+      a.insert("dog");
+      a.insert("fog");
+      a.insert("god");
+      a.insert("gold");
+      a.insert("loo");
+      a.insert("odd");
+      a.insert("of");
+      a.insert("oo");
+
+      it("provides no keys in Ø", []() {
+        anatree<> b;
+
+        size_t calls = 0u;
+        b.keys([&calls](const std::string &) { ++calls; });
+        AssertThat(calls, Is().EqualTo(0u));
+      });
+
+      it("provides the same keys as keys()", [&]() {
+        std::unordered_set<std::string> res;
+        size_t calls = 0u;
+        a.keys([&](const std::string &w) { res.insert(w); ++calls; });
+
+        AssertThat(calls, Is().EqualTo(4u));
+        AssertThat(res == a.keys(), Is().True());
+      });
+
+      it("stops calling 'f' when it returns false", [&]() {
+        size_t calls = 0u;
+        a.keys([&calls](const std::string &) { return ++calls < 2u; });
+        AssertThat(calls, Is().EqualTo(2u));
+      });
+    });
+
     // -------------------------------------------------------------------------
     describe("insert(w), keys(word_length)", []() {
       it("can find 0-keys in Ø", []() {
@@ -1124,6 +1666,632 @@ go_bandit([]() {
         }
       });
     });
+
+    // -------------------------------------------------------------------------
+    describe("insert(w), anagrams_of() by reference", []() {
+      it("provides the same set for anagrams of 'dog' and 'god'", []() {
+        anatree<> a;
+        a.insert("dog");
+        a.insert("god");
+        a.insert("do");
+
+        const auto &res1 = a.anagrams_of("dog");
+        const auto &res2 = a.anagrams_of("ogd");
+        AssertThat(&res1 == &res2, Is().True());
+        AssertThat(res1.size(), Is().EqualTo(2u));
+      });
+
+      it("provides an empty set for anagrams of 'dogs'", []() {
+        anatree<> a;
+        a.insert("dog");
+
+        const auto &res = a.anagrams_of("dogs");
+        AssertThat(res.empty(), Is().True());
+      });
+    });
+
+    // -------------------------------------------------------------------------
+    describe("insert(w), subanagrams_of(w, f)", []() {
+      it("does not call 'f' for subanagrams of 'a' in Ø", []() {
+        anatree<> a;
+
+        size_t calls = 0u;
+        a.subanagrams_of("a", [&calls](const std::string &) { calls++; });
+        AssertThat(calls, Is().EqualTo(0u));
+      });
+
+      it("calls 'f' once for each subanagram of 'gold'", []() {
+        anatree<> a;
+        a.insert("do");
+        a.insert("dog");
+        a.insert("fog");
+        a.insert("god");
+        a.insert("gold");
+        a.insert("loo");
+        a.insert("odd");
+        a.insert("of");
+        a.insert("oo");
+
+        std::vector<std::string> res;
+        a.subanagrams_of("gold", [&res](const std::string &w) { res.push_back(w); });
+        AssertThat(res.size(), Is().EqualTo(4u));
+
+        std::sort(res.begin(), res.end());
+        AssertThat(res[0], Is().EqualTo("do"));
+        AssertThat(res[1], Is().EqualTo("dog"));
+        AssertThat(res[2], Is().EqualTo("god"));
+        AssertThat(res[3], Is().EqualTo("gold"));
+      });
+    });
+
+    // -------------------------------------------------------------------------
+    describe("insert(w), subanagrams_of(w, min_length, max_length, wildcards)", []() {
+      anatree<> a;
+      a.insert("do");
+      a.insert("dog");
+      a.insert("fog");
+      a.insert("god");
+      a.insert("gold");
+      a.insert("loo");
+      a.insert("odd");
+      a.insert("of");
+      a.insert("oo");
+
+      it("can find subanagrams of 'gold' of length 3", [&]() {
+        const std::unordered_set<std::string> expected = { "dog", "god" };
+        AssertThat(a.subanagrams_of("gold", 3u, 3u) == expected, Is().True());
+      });
+
+      it("can find subanagrams of 'gold' of length 3 to 4", [&]() {
+        const std::unordered_set<std::string> expected = { "dog", "god", "gold" };
+        AssertThat(a.subanagrams_of("gold", 3u, 4u) == expected, Is().True());
+      });
+
+      it("can find subanagrams of 'gold' of length 0 to 2", [&]() {
+        const std::unordered_set<std::string> expected = { "do" };
+        AssertThat(a.subanagrams_of("gold", 0u, 2u) == expected, Is().True());
+      });
+
+      it("finds no subanagrams of 'gold' of length 5", [&]() {
+        AssertThat(a.subanagrams_of("gold", 5u, 10u).size(), Is().EqualTo(0u));
+      });
+
+      it("can find subanagrams of 'go' with 1 wildcard", [&]() {
+        const std::unordered_set<std::string> expected = { "do", "dog", "fog", "god", "of", "oo" };
+        AssertThat(a.subanagrams_of("go", 0u, 10u, 1u) == expected, Is().True());
+      });
+
+      it("can find subanagrams of 'go' of length 3 with 1 wildcard", [&]() {
+        const std::unordered_set<std::string> expected = { "dog", "fog", "god" };
+        AssertThat(a.subanagrams_of("go", 3u, 3u, 1u) == expected, Is().True());
+      });
+
+      it("can find subanagrams of '' with 2 wildcards", [&]() {
+        const std::unordered_set<std::string> expected = { "do", "of", "oo" };
+        AssertThat(a.subanagrams_of("", 0u, 10u, 2u) == expected, Is().True());
+      });
+
+      it("can find subanagrams of std::string_view 'gold' of length 4", [&]() {
+        const std::string_view w = "gold";
+        const std::unordered_set<std::string> expected = { "gold" };
+        AssertThat(a.subanagrams_of(w, 4u, 4u) == expected, Is().True());
+      });
+
+      it("ignores letters of 'gxoqld' that are in none of the words", [&]() {
+        AssertThat(a.subanagrams_of("gxoqld") == a.subanagrams_of("gold"), Is().True());
+        AssertThat(a.count_subanagrams_of("gxoqld"), Is().EqualTo(4u));
+        AssertThat(a.has_subanagram_of("gxoqld", 4u), Is().True());
+        AssertThat(a.has_subanagram_of("gxoqld", 5u), Is().False());
+      });
+
+      it("can find subanagrams of 'gxo' with 1 wildcard", [&]() {
+        const std::unordered_set<std::string> expected = { "do", "dog", "fog", "god", "of", "oo" };
+        AssertThat(a.subanagrams_of("gxo", 0u, 10u, 1u) == expected, Is().True());
+      });
+
+      it("can find subanagrams with new letters after more words are inserted", [&]() {
+        anatree<> b = a;
+        AssertThat(b.count_subanagrams_of("xyz"), Is().EqualTo(0u));
+        AssertThat(b.contains("zyx"), Is().False());
+
+        b.insert("zyx");
+        AssertThat(b.count_subanagrams_of("xyz"), Is().EqualTo(1u));
+        AssertThat(b.contains("zyx"), Is().True());
+      });
+    });
+
+    // -------------------------------------------------------------------------
+    describe("insert(w), count_subanagrams_of(), has_subanagram_of(), any_subanagrams_of()", []() {
+      anatree<> a;
+      a.insert("do");
+      a.insert("dog");
+      a.insert("fog");
+      a.insert("god");
+      a.insert("gold");
+      a.insert("loo");
+      a.insert("odd");
+      a.insert("of");
+      a.insert("oo");
+
+      it("counts 0 subanagrams of 'a'", [&]() {
+        AssertThat(a.count_subanagrams_of("a"), Is().EqualTo(0u));
+      });
+
+      it("counts 4 subanagrams of 'gold'", [&]() {
+        AssertThat(a.count_subanagrams_of("gold"), Is().EqualTo(4u));
+      });
+
+      it("counts 4 subanagrams of std::string_view 'gold'", [&]() {
+        const std::string_view w = "gold";
+        AssertThat(a.count_subanagrams_of(w), Is().EqualTo(4u));
+      });
+
+      it("has subanagrams of 'gold' of length 0 to 4", [&]() {
+        AssertThat(a.has_subanagram_of("gold"), Is().True());
+        AssertThat(a.has_subanagram_of("gold", 3u), Is().True());
+        AssertThat(a.has_subanagram_of("gold", 4u), Is().True());
+      });
+
+      it("has no subanagrams of 'gold' of length 5", [&]() {
+        AssertThat(a.has_subanagram_of("gold", 5u), Is().False());
+      });
+
+      it("has subanagrams of 'ooo' of length 2 but not 3", [&]() {
+        AssertThat(a.has_subanagram_of("ooo", 2u), Is().True());
+        AssertThat(a.has_subanagram_of("ooo", 3u), Is().False());
+      });
+
+      it("has no subanagrams of 'a'", [&]() {
+        AssertThat(a.has_subanagram_of("a"), Is().False());
+      });
+
+      it("can obtain 2 of the subanagrams of 'gold'", [&]() {
+        const auto res = a.any_subanagrams_of("gold", 2u);
+        AssertThat(res.size(), Is().EqualTo(2u));
+
+        const auto all = a.subanagrams_of("gold");
+        for (const auto &w : res) {
+          AssertThat(all.contains(w), Is().True());
+        }
+      });
+
+      it("can obtain all of the subanagrams of 'gold' if 'k' is larger", [&]() {
+        AssertThat(a.any_subanagrams_of("gold", 10u) == a.subanagrams_of("gold"), Is().True());
+      });
+
+      it("obtains none of the subanagrams of 'gold' for 'k' = 0", [&]() {
+        AssertThat(a.any_subanagrams_of("gold", 0u).size(), Is().EqualTo(0u));
+      });
+
+      it("stops calling 'f' when it returns false", [&]() {
+        size_t calls = 0u;
+        a.subanagrams_of("gold", [&calls](const std::string &) { return ++calls < 3u; });
+        AssertThat(calls, Is().EqualTo(3u));
+      });
+
+      it("counts the same after building the tree in bulk", [&]() {
+        const std::vector<std::string> ws = { "do", "dog", "fog", "god", "gold", "loo", "odd", "of", "oo" };
+        const anatree<> b(ws.begin(), ws.end());
+
+        AssertThat(b.count_subanagrams_of("gold"), Is().EqualTo(4u));
+        AssertThat(b.has_subanagram_of("gold", 4u), Is().True());
+        AssertThat(b.has_subanagram_of("gold", 5u), Is().False());
+      });
+    });
+
+    // -------------------------------------------------------------------------
+    describe("insert(w), parallel_subanagrams_of(w)", []() {
+      // Enough words for the search to be split into several tasks.
+      std::vector<std::string> ws;
+      for (char a = 'a'; a <= 'j'; ++a) {
+        for (char b = 'a'; b <= 'j'; ++b) {
+          for (char c = 'a'; c <= 'j'; ++c) {
+            ws.push_back(std::string{ a, b, c });
+            ws.push_back(std::string{ a, b, c, a });
+          }
+        }
+      }
+
+      const anatree<> a(ws.begin(), ws.end());
+
+      it("finds no subanagrams of 'xyz'", [&]() {
+        AssertThat(a.parallel_subanagrams_of("xyz", 4u).size(), Is().EqualTo(0u));
+      });
+
+      it("finds the same subanagrams of 'abcdefg' as subanagrams_of(w)", [&]() {
+        const auto expected = a.subanagrams_of("abcdefg");
+        AssertThat(a.parallel_subanagrams_of("abcdefg", 1u) == expected, Is().True());
+        AssertThat(a.parallel_subanagrams_of("abcdefg", 4u) == expected, Is().True());
+        AssertThat(a.parallel_subanagrams_of("abcdefg") == expected, Is().True());
+      });
+
+      it("finds the same subanagrams of 'aaaabbbbccccddddeeeeffffgggghhhhiiiijjjj' as subanagrams_of(w)", [&]() {
+        const auto expected = a.subanagrams_of("aaaabbbbccccddddeeeeffffgggghhhhiiiijjjj");
+        AssertThat(expected.size(), Is().EqualTo(ws.size()));
+        AssertThat(a.parallel_subanagrams_of("aaaabbbbccccddddeeeeffffgggghhhhiiiijjjj", 3u) == expected, Is().True());
+      });
+
+      it("finds the same subanagrams of std::string_view 'abcdefg'", [&]() {
+        const std::string_view w = "abcdefg";
+        AssertThat(a.parallel_subanagrams_of(w, 2u) == a.subanagrams_of(w), Is().True());
+      });
+
+      it("finds the same subanagrams with a set of words without merge(...)", [&]() {
+        struct set_type : std::unordered_set<std::string>
+        {
+          using std::unordered_set<std::string>::unordered_set;
+          void merge(std::unordered_set<std::string>&) = delete;
+        };
+        const anatree<std::string, std::less<char>, set_type> b(ws.begin(), ws.end());
+
+        const auto expected = b.subanagrams_of("abcdefg");
+        AssertThat(expected.size(), Is().EqualTo(a.subanagrams_of("abcdefg").size()));
+        AssertThat(b.parallel_subanagrams_of("abcdefg", 4u) == expected, Is().True());
+      });
+    });
+
+    // -------------------------------------------------------------------------
+    describe("insert(w), begin(), end()", []() {
+      it("has no words in Ø", []() {
+        const anatree<> a;
+        AssertThat(a.begin() == a.end(), Is().True());
+      });
+
+      it("has the empty word of { \"\" }", []() {
+        anatree<> a;
+        a.insert("");
+
+        const std::vector<std::string> ws(a.begin(), a.end());
+        AssertThat(ws == std::vector<std::string>({ "" }), Is().True());
+      });
+
+      it("visits all words of { \"dog\", \"do\", \"god\", \"gold\", \"a\", \"og\" } in the order of their keys", []() {
+        anatree<> a;
+        for (const std::string w : { "dog", "do", "god", "gold", "a", "og" }) { a.insert(w); }
+
+        std::vector<std::string> ws;
+        for (const std::string &w : a) { ws.push_back(w); }
+
+        AssertThat(ws.size(), Is().EqualTo(a.size()));
+        AssertThat(ws[0], Is().EqualTo("a"));
+        AssertThat(ws[1], Is().EqualTo("gold"));
+        AssertThat((ws[2] == "dog" && ws[3] == "god") || (ws[2] == "god" && ws[3] == "dog"), Is().True());
+        AssertThat(ws[4], Is().EqualTo("do"));
+        AssertThat(ws[5], Is().EqualTo("og"));
+      });
+
+      it("skips the words that have been erased", []() {
+        anatree<> a;
+        for (const std::string w : { "dog", "do", "god", "gold" }) { a.insert(w); }
+        a.erase("do");
+        a.erase("gold");
+
+        const std::unordered_set<std::string> ws(a.begin(), a.end());
+        AssertThat(ws == std::unordered_set<std::string>({ "dog", "god" }), Is().True());
+      });
+
+      it("can be used as a forward range", []() {
+        anatree<> a;
+        for (const std::string w : { "ab", "ba", "abc", "c" }) { a.insert(w); }
+
+        AssertThat(std::ranges::distance(a), Is().EqualTo(4));
+
+        auto it = a.begin();
+        const auto first = it++;
+        AssertThat(first == a.begin(), Is().True());
+        AssertThat(it == a.begin(), Is().False());
+      });
+    });
+
+    // -------------------------------------------------------------------------
+    describe("insert(w), subanagrams_range(w)", []() {
+      anatree<> a;
+      for (const std::string w : { "", "a", "do", "dog", "god", "gold", "good", "og", "zoo" }) {
+        a.insert(w);
+      }
+
+      it("has no subanagrams of 'x' in Ø", []() {
+        const anatree<> e;
+        auto r = e.subanagrams_range("x");
+        AssertThat(r.begin() == r.end(), Is().True());
+      });
+
+      it("finds the same subanagrams of 'goldo' as subanagrams_of(w)", [&]() {
+        std::unordered_set<std::string> ws;
+        for (const std::string &w : a.subanagrams_range("goldo")) { ws.insert(w); }
+        AssertThat(ws == a.subanagrams_of("goldo"), Is().True());
+      });
+
+      it("finds the same subanagrams of std::string_view 'dogz'", [&]() {
+        const std::string_view w = "dogz";
+
+        std::unordered_set<std::string> ws;
+        for (const std::string &sw : a.subanagrams_range(w)) { ws.insert(sw); }
+        AssertThat(ws == a.subanagrams_of(w), Is().True());
+      });
+
+      it("finds the same subanagrams of 'goldxo' within bounds as subanagrams_of(w, ...)", [&]() {
+        std::unordered_set<std::string> ws;
+        for (const std::string &w : a.subanagrams_range("goldxo", 2u, 3u, 1u)) { ws.insert(w); }
+        AssertThat(ws == a.subanagrams_of("goldxo", 2u, 3u, 1u), Is().True());
+      });
+
+      it("only searches for as many words as are taken", [&]() {
+        std::vector<std::string> ws;
+        for (const std::string &w : a.subanagrams_range("abdgloooz") | std::views::take(3)) {
+          ws.push_back(w);
+        }
+        AssertThat(ws.size(), Is().EqualTo(3u));
+        for (const std::string &w : ws) { AssertThat(a.contains(w), Is().True()); }
+      });
+
+      it("can be moved before it is read", [&]() {
+        auto r = a.subanagrams_range("dog");
+        auto s = std::move(r);
+
+        size_t words = 0u;
+        for (const std::string &w : s) { words += a.contains(w); }
+        AssertThat(words, Is().EqualTo(a.count_subanagrams_of("dog")));
+      });
+    });
+
+    // -------------------------------------------------------------------------
+    describe("insert(w), contains_batch(), has_anagram_of_batch(), anagrams_of_batch()", []() {
+      anatree<> a;
+      a.insert("do");
+      a.insert("dog");
+      a.insert("god");
+      a.insert("gold");
+      a.insert("odd");
+
+      const std::vector<std::string> ws = { "god", "x", "dgo", "", "do", "gold", "go", "dog" };
+
+      it("looks up nothing for an empty batch", [&]() {
+        const std::vector<std::string> none;
+        AssertThat(a.contains_batch(none.begin(), none.end()).size(), Is().EqualTo(0u));
+        AssertThat(a.anagrams_of_batch(none.begin(), none.end()).size(), Is().EqualTo(0u));
+      });
+
+      it("can check whether words are contained", [&]() {
+        const std::vector<bool> expected = { true, false, false, false, true, true, false, true };
+        AssertThat(a.contains_batch(ws.begin(), ws.end()) == expected, Is().True());
+      });
+
+      it("can check whether words have anagrams", [&]() {
+        const std::vector<bool> expected = { true, false, true, false, true, true, false, true };
+        AssertThat(a.has_anagram_of_batch(ws.begin(), ws.end()) == expected, Is().True());
+      });
+
+      it("can obtain anagrams of words", [&]() {
+        const auto res = a.anagrams_of_batch(ws.begin(), ws.end());
+        AssertThat(res.size(), Is().EqualTo(ws.size()));
+
+        for (size_t i = 0u; i < ws.size(); ++i) {
+          AssertThat(&res[i].get() == &a.anagrams_of(ws[i]), Is().True());
+        }
+
+        const std::unordered_set<std::string> expected = { "dog", "god" };
+        AssertThat(res[2].get() == expected, Is().True());
+        AssertThat(res[1].get().size(), Is().EqualTo(0u));
+      });
+
+      it("provides the same results with several threads", [&]() {
+        std::vector<std::string> many;
+        for (size_t i = 0u; i < 4u * anatree<>::batch_cutoff; ++i) {
+          many.push_back(ws[i % ws.size()]);
+        }
+
+        const auto expected = a.contains_batch(many.begin(), many.end());
+        AssertThat(a.contains_batch(many.begin(), many.end(), 4u) == expected, Is().True());
+        AssertThat(a.contains_batch(many.begin(), many.end(), 0u) == expected, Is().True());
+
+        const auto res = a.anagrams_of_batch(many.begin(), many.end(), 3u);
+        for (size_t i = 0u; i < many.size(); ++i) {
+          AssertThat(&res[i].get() == &a.anagrams_of(many[i]), Is().True());
+        }
+      });
+    });
+
+    // -------------------------------------------------------------------------
+    describe("insert(w), queries with std::string_view", []() {
+      anatree<> a;
+      a.insert("do");
+      a.insert("dog");
+      a.insert("god");
+      a.insert("gold");
+
+      it("can check for anagrams of 'odg'", [&a]() {
+        AssertThat(a.has_anagram_of(std::string_view("odg")), Is().True());
+        AssertThat(a.has_anagram_of(std::string_view("og")), Is().False());
+      });
+
+      it("can find anagrams of 'odg'", [&a]() {
+        const auto &res = a.anagrams_of(std::string_view("odg"));
+        AssertThat(res.size(), Is().EqualTo(2u));
+        AssertThat(res.contains("dog"), Is().True());
+        AssertThat(res.contains("god"), Is().True());
+      });
+
+      it("can find subanagrams of 'gold'", [&a]() {
+        const auto res = a.subanagrams_of(std::string_view("gold"));
+        AssertThat(res.size(), Is().EqualTo(4u));
+        AssertThat(res == a.subanagrams_of("gold"), Is().True());
+      });
+
+      it("can stream subanagrams of 'dog'", [&a]() {
+        size_t calls = 0u;
+        a.subanagrams_of(std::string_view("dog"), [&calls](const std::string &) { calls++; });
+        AssertThat(calls, Is().EqualTo(3u));
+      });
+
+      it("can check for 'dog' and 'odg'", [&a]() {
+        AssertThat(a.contains(std::string_view("dog")), Is().True());
+        AssertThat(a.contains(std::string_view("odg")), Is().False());
+        AssertThat(a.contains(std::string_view("cat")), Is().False());
+      });
+
+      it("can insert 'cat' and 'act'", []() {
+        anatree<> b;
+        b.insert(std::string_view("cat"));
+        b.insert(std::string_view("act"));
+        b.insert(std::string_view("cat"));
+
+        AssertThat(b.size(), Is().EqualTo(2u));
+        AssertThat(b.contains("cat"), Is().True());
+        AssertThat(b.contains("act"), Is().True());
+        AssertThat(b.anagrams_of("tac").size(), Is().EqualTo(2u));
+      });
+
+      it("can erase 'cat' and 'act'", []() {
+        anatree<> b;
+        b.insert("cat");
+        b.insert("act");
+
+        AssertThat(b.erase(std::string_view("tca")), Is().EqualTo(0u));
+        AssertThat(b.erase(std::string_view("cat")), Is().EqualTo(1u));
+        AssertThat(b.erase(std::string_view("cat")), Is().EqualTo(0u));
+
+        AssertThat(b.size(), Is().EqualTo(1u));
+        AssertThat(b.contains("cat"), Is().False());
+        AssertThat(b.contains("act"), Is().True());
+
+        AssertThat(b.erase(std::string_view("act")), Is().EqualTo(1u));
+        AssertThat(b.empty(), Is().True());
+        AssertThat(b.tree_size(), Is().EqualTo(1u));
+      });
+
+      it("can be built from views", []() {
+        const std::vector<std::string_view> ws = { "do", "dog", "god" };
+        const anatree<> b(ws.begin(), ws.end());
+
+        AssertThat(b.size(), Is().EqualTo(3u));
+        AssertThat(b.contains(std::string_view("god")), Is().True());
+      });
+
+      it("can look up views with a transparent hash", []() {
+        using set_type = std::unordered_set<std::string, transparent_hash<std::string>, std::equal_to<>>;
+        using tree = anatree<std::string, std::less<char>, set_type>;
+
+        tree b;
+        b.insert(std::string_view("dog"));
+        b.insert(std::string_view("god"));
+
+        AssertThat(b.size(), Is().EqualTo(2u));
+        AssertThat(b.contains(std::string_view("dog")), Is().True());
+        AssertThat(b.contains(std::string_view("odg")), Is().False());
+        AssertThat(b.contains("god"), Is().True());
+      });
+    });
+
+    // -------------------------------------------------------------------------
+    describe("insert(T&&), emplace(...)", []() {
+      it("can move 'dog' into the tree", []() {
+        anatree<> a;
+        std::string w = "dog";
+        a.insert(std::move(w));
+        a.insert(std::string("god"));
+
+        AssertThat(a.size(), Is().EqualTo(2u));
+        AssertThat(a.contains("dog"), Is().True());
+        AssertThat(a.contains("god"), Is().True());
+      });
+
+      it("does not add a moved word twice", []() {
+        anatree<> a;
+        a.insert(std::string("dog"));
+        a.insert(std::string("dog"));
+
+        AssertThat(a.size(), Is().EqualTo(1u));
+      });
+
+      it("can emplace 'aaa' and 'ab'", []() {
+        anatree<> a;
+        a.emplace(3u, 'a');
+        a.emplace("abc", 2u);
+
+        AssertThat(a.size(), Is().EqualTo(2u));
+        AssertThat(a.contains("aaa"), Is().True());
+        AssertThat(a.contains("ab"), Is().True());
+      });
+
+      it("can move words in bulk", []() {
+        std::vector<std::string> ws = { "do", "dog", "god" };
+        const anatree<> a(std::make_move_iterator(ws.begin()), std::make_move_iterator(ws.end()));
+
+        AssertThat(a.size(), Is().EqualTo(3u));
+        AssertThat(a.contains("god"), Is().True());
+      });
+    });
+
+    // -------------------------------------------------------------------------
+    describe("insert(w), queries on long words", []() {
+      // Longer than the inline key buffer and sorted with a counting sort.
+      const std::string w1 = std::string(300, 'b') + std::string(200, 'a') + "c";
+      const std::string w2 = "c" + std::string(200, 'a') + std::string(300, 'b');
+      const std::string w3 = std::string(100, 'a') + std::string(50, 'b');
+
+      anatree<> a;
+      a.insert(w1);
+      a.insert(w3);
+
+      it("contains the inserted long words", [&]() {
+        AssertThat(a.size(), Is().EqualTo(2u));
+        AssertThat(a.contains(w1), Is().True());
+        AssertThat(a.contains(w2), Is().False());
+        AssertThat(a.contains(w3), Is().True());
+      });
+
+      it("can find anagrams of a long word", [&]() {
+        AssertThat(a.has_anagram_of(w2), Is().True());
+
+        const auto &res = a.anagrams_of(w2);
+        AssertThat(res.size(), Is().EqualTo(1u));
+        AssertThat(res.contains(w1), Is().True());
+      });
+
+      it("can find subanagrams of a long word", [&]() {
+        const auto res = a.subanagrams_of(w2);
+        AssertThat(res.size(), Is().EqualTo(2u));
+        AssertThat(res.contains(w1), Is().True());
+        AssertThat(res.contains(w3), Is().True());
+      });
+    });
+
+    describe("insert(w), queries on deep trees", []() {
+      // The tree is as deep as the longest word is long, which would exhaust a
+      // small stack with a recursive traversal.
+      std::vector<std::string> ws;
+      for (size_t i = 1; i <= 4; ++i) {
+        std::string w;
+        for (int c = 0; c < 20000; ++c) {
+          w += std::to_string(c % 10);
+        }
+        ws.push_back(w.substr(0, w.size() / i));
+      }
+
+      anatree<> a;
+      for (const auto &w : ws) { a.insert(w); }
+
+      it("contains the inserted words", [&]() {
+        AssertThat(a.size(), Is().EqualTo(4u));
+        for (const auto &w : ws) { AssertThat(a.contains(w), Is().True()); }
+      });
+
+      it("can find subanagrams", [&]() {
+        AssertThat(a.subanagrams_of(ws[0]).size(), Is().EqualTo(4u));
+        AssertThat(a.subanagrams_of(ws[1]).size(), Is().EqualTo(3u));
+      });
+
+      it("can list keys of a given length", [&]() {
+        AssertThat(a.keys(ws[3].size()).size(), Is().EqualTo(1u));
+      });
+
+      it("can be copied", [&]() {
+        const anatree<> b(a);
+        AssertThat(b.size(), Is().EqualTo(4u));
+        AssertThat(b.tree_size(), Is().EqualTo(a.tree_size()));
+      });
+    });
   });
 
   describe("anatree<std::string, std::greater>", []() {
@@ -1150,6 +2318,176 @@ go_bandit([]() {
     });
   });
 
+  describe("anatree<std::string, frequency_order<char>>", []() {
+    // 'a' is in all words, 'b' in half of them, and 'c' in one.
+    const std::vector<std::string> ws = { "a", "ab", "abc", "ba", "aa" };
+
+    using order = frequency_order<char>;
+    using tree  = anatree<std::string, order>;
+
+    it("orders characters naturally by default", []() {
+      const order o;
+      AssertThat(o('a', 'b'), Is().True());
+      AssertThat(o('b', 'a'), Is().False());
+      AssertThat(o('a', 'a'), Is().False());
+    });
+
+    it("orders characters rarest first", [&]() {
+      const order o(ws.begin(), ws.end(), order::strategy::rarest_first);
+      AssertThat(o('c', 'b'), Is().True());
+      AssertThat(o('b', 'a'), Is().True());
+      AssertThat(o('a', 'c'), Is().False());
+    });
+
+    it("orders characters most frequent first", [&]() {
+      const order o(ws.begin(), ws.end(), order::strategy::most_frequent_first);
+      AssertThat(o('a', 'b'), Is().True());
+      AssertThat(o('b', 'c'), Is().True());
+      AssertThat(o('c', 'a'), Is().False());
+    });
+
+    it("orders characters most discriminating first", [&]() {
+      const order o(ws.begin(), ws.end(), order::strategy::most_discriminating_first);
+      AssertThat(o('b', 'a'), Is().True());
+      AssertThat(o('b', 'c'), Is().True());
+    });
+
+    it("orders unseen characters last", [&]() {
+      const order o(ws.begin(), ws.end(), order::strategy::rarest_first);
+      AssertThat(o('a', 'd'), Is().True());
+      AssertThat(o('d', 'e'), Is().True());
+      AssertThat(o('e', 'd'), Is().False());
+    });
+
+    it("finds the same anagrams and subanagrams for any strategy", [&]() {
+      const anatree<> expected(ws.begin(), ws.end());
+
+      for (const auto s : order::strategies) {
+        const order o(ws.begin(), ws.end(), s);
+        const tree a(ws.begin(), ws.end(), o);
+
+        AssertThat(a.size(), Is().EqualTo(ws.size()));
+        for (const auto &w : ws) {
+          AssertThat(a.contains(w), Is().True());
+        }
+        AssertThat(a.anagrams_of("ab") == expected.anagrams_of("ab"), Is().True());
+        AssertThat(a.subanagrams_of("abc") == expected.subanagrams_of("abc"), Is().True());
+        AssertThat(a.subanagrams_of("aab") == expected.subanagrams_of("aab"), Is().True());
+      }
+    });
+
+    it("can insert words one at a time", [&]() {
+      const order o(ws.begin(), ws.end(), order::strategy::rarest_first);
+      tree a(o);
+      for (const auto &w : ws) { a.insert(w); }
+
+      AssertThat(a.tree_size(), Is().EqualTo(tree(ws.begin(), ws.end(), o).tree_size()));
+      AssertThat(a.subanagrams_of("abc").size(), Is().EqualTo(4u));
+    });
+
+    it("reports the tree_size() of each strategy", [&]() {
+      for (const auto s : order::strategies) {
+        const order o(ws.begin(), ws.end(), s);
+        const tree a(ws.begin(), ws.end(), o);
+
+        AssertThat(tree::tree_size_of(ws.begin(), ws.end(), o), Is().EqualTo(a.tree_size()));
+      }
+      AssertThat(anatree<>::tree_size_of(ws.begin(), ws.end()),
+                 Is().EqualTo(anatree<>(ws.begin(), ws.end()).tree_size()));
+    });
+
+    it("can be frozen, saved, and loaded", [&]() {
+      const order o(ws.begin(), ws.end(), order::strategy::rarest_first);
+      const tree a(ws.begin(), ws.end(), o);
+
+      const std::string path = (std::filesystem::temp_directory_path() / "anatree_frequency_order.bin").string();
+      a.freeze().save(path);
+
+      const auto f = frozen_anatree<std::string, order>::load(path, o);
+      AssertThat(f.subanagrams_of("abc") == a.subanagrams_of("abc"), Is().True());
+
+      std::filesystem::remove(path);
+    });
+  });
+
+  describe("anatree<std::string, alphabet<...>>", []() {
+    using dna = alphabet<'T', 'G', 'C', 'A'>;
+    using az  = alphabet_range<'a', 'z'>;
+
+    it("maps letters to dense indices", []() {
+      AssertThat(dna::size, Is().EqualTo(4u));
+      AssertThat(dna::bits, Is().EqualTo(2u));
+      AssertThat(dna::index_of('T'), Is().EqualTo(0u));
+      AssertThat(dna::index_of('A'), Is().EqualTo(3u));
+      AssertThat(dna::index_of('X'), Is().EqualTo(dna::size));
+
+      AssertThat(az::size, Is().EqualTo(26u));
+      AssertThat(az::bits, Is().EqualTo(5u));
+      AssertThat(az::index_of('c'), Is().EqualTo(2u));
+    });
+
+    it("orders letters as given and all other characters last", []() {
+      const dna o;
+      AssertThat(o('T', 'A'), Is().True());
+      AssertThat(o('A', 'T'), Is().False());
+      AssertThat(o('A', 'B'), Is().True());
+      AssertThat(o('B', 'X'), Is().True());
+      AssertThat(o('X', 'B'), Is().False());
+    });
+
+    it("marks NIL nodes with a character outside of the alphabet", []() {
+      AssertThat(dna::contains(dna::nil), Is().False());
+      using zero = alphabet<'\0', 'a'>;
+      AssertThat(zero::nil, Is().EqualTo('\1'));
+    });
+
+    const std::vector<std::string> ws = { "ACGT", "TGCA", "AAC", "CA", "GATTACA", "TTTTTTTTGA" };
+
+    it("has the same words and tree size as with 'std::less'", [&]() {
+      const anatree<std::string, dna> a(ws.begin(), ws.end());
+      const anatree<> b(ws.begin(), ws.end());
+
+      AssertThat(a.size(), Is().EqualTo(b.size()));
+      for (const auto &w : ws) {
+        AssertThat(a.contains(w), Is().True());
+      }
+      AssertThat(a.anagrams_of("CGTA").size(), Is().EqualTo(2u));
+      AssertThat(a.subanagrams_of("GATTACA") == b.subanagrams_of("GATTACA"), Is().True());
+      AssertThat(a.keys().size(), Is().EqualTo(b.keys().size()));
+    });
+
+    it("can store words with characters outside of the alphabet", []() {
+      anatree<std::string, dna> a;
+      a.insert("ACNT");
+      a.insert("NA");
+
+      AssertThat(a.contains("ACNT"), Is().True());
+      AssertThat(a.contains("TNCA"), Is().False());
+      AssertThat(a.anagrams_of("TNCA").size(), Is().EqualTo(1u));
+      AssertThat(a.subanagrams_of("ACNT").size(), Is().EqualTo(2u));
+    });
+
+    it("can store words with the character 0 if it is a letter", []() {
+      anatree<std::string, alphabet<'\0', 'a'>> a;
+      const std::string w("a\0a", 3u);
+      a.insert(w);
+      a.insert(std::string(1u, '\0'));
+
+      AssertThat(a.size(), Is().EqualTo(2u));
+      AssertThat(a.contains(w), Is().True());
+      AssertThat(a.subanagrams_of(w).size(), Is().EqualTo(2u));
+    });
+
+    it("can freeze a tree of 'a' to 'z'", []() {
+      const std::vector<std::string> ws = { "do", "dog", "god", "gold" };
+      const anatree<std::string, az> a(ws.begin(), ws.end());
+      const auto f = a.freeze();
+
+      AssertThat(f.contains("gold"), Is().True());
+      AssertThat(f.subanagrams_of("gold").size(), Is().EqualTo(4u));
+    });
+  });
+
   describe("anatree<std::wstring, ...>", []() {
     anatree<std::wstring> a;
 
@@ -1231,6 +2569,657 @@ go_bandit([]() {
       AssertThat(res.contains(u8"ø"), Is().True());
     });
   });
+
+  describe("frozen_anatree<std::string, std::less>", []() {
+    it("can freeze Ø", []() {
+      anatree<> a;
+      const frozen_anatree<> f = a.freeze();
+
+      AssertThat(f.size(), Is().EqualTo(0u));
+      AssertThat(f.empty(), Is().True());
+      AssertThat(f.tree_size(), Is().EqualTo(1u));
+      AssertThat(f.dag_size(), Is().EqualTo(2u));
+
+      AssertThat(f.contains(""), Is().False());
+      AssertThat(f.has_anagram_of(""), Is().False());
+      AssertThat(f.subanagrams_of("a").empty(), Is().True());
+    });
+
+    it("can freeze { '' }", []() {
+      anatree<> a;
+      a.insert("");
+      const frozen_anatree<> f = a.freeze();
+
+      AssertThat(f.size(), Is().EqualTo(1u));
+      AssertThat(f.contains(""), Is().True());
+      AssertThat(f.has_anagram_of(""), Is().True());
+      AssertThat(f.contains("a"), Is().False());
+    });
+
+    anatree<> a;
+    a.insert("do");
+    a.insert("dog");
+    a.insert("fog");
+    a.insert("god");
+    a.insert("gold");
+    a.insert("loo");
+    a.insert("odd");
+    a.insert("of");
+    a.insert("oo");
+
+    const frozen_anatree<> f = a.freeze();
+
+    it("has the same size as the original", [&]() {
+      AssertThat(f.size(), Is().EqualTo(a.size()));
+      AssertThat(f.empty(), Is().False());
+      AssertThat(f.tree_size(), Is().EqualTo(a.tree_size()));
+    });
+
+    it("contains the original words", [&]() {
+      AssertThat(f.contains("do"), Is().True());
+      AssertThat(f.contains("dog"), Is().True());
+      AssertThat(f.contains("god"), Is().True());
+      AssertThat(f.contains("gold"), Is().True());
+      AssertThat(f.contains("oo"), Is().True());
+
+      AssertThat(f.contains(""), Is().False());
+      AssertThat(f.contains("o"), Is().False());
+      AssertThat(f.contains("odg"), Is().False());
+      AssertThat(f.contains("good"), Is().False());
+    });
+
+    it("can check for anagrams", [&]() {
+      AssertThat(f.has_anagram_of("odg"), Is().True());
+      AssertThat(f.has_anagram_of("lodg"), Is().True());
+      AssertThat(f.has_anagram_of("go"), Is().False());
+      AssertThat(f.has_anagram_of("dogs"), Is().False());
+    });
+
+    it("can find anagrams of 'dog'", [&]() {
+      const auto res = f.anagrams_of("dog");
+      AssertThat(res.size(), Is().EqualTo(2u));
+      AssertThat(res.contains("dog"), Is().True());
+      AssertThat(res.contains("god"), Is().True());
+    });
+
+    it("can find anagrams of 'dogs'", [&]() {
+      const auto res = f.anagrams_of("dogs");
+      AssertThat(res.empty(), Is().True());
+    });
+
+    it("can find subanagrams of 'gold'", [&]() {
+      const auto res = f.subanagrams_of("gold");
+      AssertThat(res.size(), Is().EqualTo(4u));
+      AssertThat(res.contains("gold"), Is().True());
+      AssertThat(res.contains("dog"), Is().True());
+      AssertThat(res.contains("god"), Is().True());
+      AssertThat(res.contains("do"), Is().True());
+    });
+
+    it("can find subanagrams of 'goldfood'", [&]() {
+      const auto res = f.subanagrams_of("goldfood");
+      AssertThat(res == a.subanagrams_of("goldfood"), Is().True());
+    });
+
+    it("can stream subanagrams of 'gold' as views", [&]() {
+      std::unordered_set<std::string> res;
+      f.subanagrams_of("gold", [&res](const std::string_view w) { res.insert(std::string(w)); });
+      AssertThat(res == a.subanagrams_of("gold"), Is().True());
+    });
+
+    it("stops streaming subanagrams when 'f' returns false", [&]() {
+      size_t calls = 0u;
+      f.subanagrams_of("gold", [&calls](const std::string_view) { return ++calls < 2u; });
+      AssertThat(calls, Is().EqualTo(2u));
+    });
+
+    it("can find the identifiers of anagrams of 'dog'", [&]() {
+      const auto ids = f.anagram_ids_of("dog");
+      AssertThat(ids.size(), Is().EqualTo(2u));
+
+      std::unordered_set<std::string> res;
+      for (const auto i : ids) { res.insert(std::string(f.word_view(i))); }
+      AssertThat(res == a.anagrams_of("dog"), Is().True());
+    });
+
+    it("finds no identifiers of anagrams of 'dogs'", [&]() {
+      AssertThat(f.anagram_ids_of("dogs").empty(), Is().True());
+    });
+
+    it("can find the (sorted) identifiers of subanagrams of 'goldfood'", [&]() {
+      const auto ids = f.subanagram_ids_of("goldfood");
+      AssertThat(std::is_sorted(ids.begin(), ids.end()), Is().True());
+
+      std::unordered_set<std::string> res;
+      for (const auto i : ids) { res.insert(std::string(f.word_view(i))); }
+      AssertThat(ids.size(), Is().EqualTo(res.size()));
+      AssertThat(res == a.subanagrams_of("goldfood"), Is().True());
+    });
+
+    it("has a distinct identifier for each word", [&]() {
+      std::unordered_set<std::string> res;
+      for (frozen_anatree<>::word_id i = 0u; i < f.size(); ++i) {
+        res.insert(std::string(f.word_view(i)));
+      }
+      AssertThat(res.size(), Is().EqualTo(a.size()));
+      for (const auto &w : res) { AssertThat(a.contains(w), Is().True()); }
+    });
+
+    it("can freeze repeated characters", []() {
+      anatree<> b;
+      b.insert("aa");
+      b.insert("aaaa");
+      b.insert("aaaab");
+      b.insert("abbb");
+      b.insert("bbbb");
+      b.insert("bbbbbbbb");
+      const frozen_anatree<> fb = b.freeze();
+
+      AssertThat(fb.size(), Is().EqualTo(b.size()));
+      AssertThat(fb.tree_size(), Is().EqualTo(b.tree_size()));
+
+      AssertThat(fb.contains("aaaa"), Is().True());
+      AssertThat(fb.contains("bbbbbbbb"), Is().True());
+      AssertThat(fb.contains("aaa"), Is().False());
+      AssertThat(fb.contains("bbbbb"), Is().False());
+      AssertThat(fb.has_anagram_of("baaaa"), Is().True());
+      AssertThat(fb.has_anagram_of("bbba"), Is().True());
+      AssertThat(fb.has_anagram_of("bba"), Is().False());
+
+      for (const std::string w : { "a", "aaa", "aaaaab", "abbb", "aabbbbb", "bbbbbbb", "aaaabbbbbbbb" }) {
+        AssertThat(fb.subanagrams_of(w) == b.subanagrams_of(w), Is().True());
+      }
+    });
+
+    it("stores a run of a character in a single node", []() {
+      anatree<> run;
+      run.insert("aaaaaaaaaaaaaaaa");
+
+      anatree<> distinct;
+      distinct.insert("abcdefghijklmnop");
+
+      AssertThat(run.tree_size(), Is().EqualTo(distinct.tree_size()));
+      AssertThat(run.freeze().dag_size() < distinct.freeze().dag_size(), Is().True());
+      AssertThat(run.freeze().memory_size() < distinct.freeze().memory_size(), Is().True());
+    });
+
+    it("shares structurally equal subtrees", []() {
+      anatree<> b;
+      b.insert("ax");
+      b.insert("bx");
+      b.insert("cx");
+      b.insert("dx");
+      const frozen_anatree<> fb = b.freeze();
+
+      // The four 'x' nodes (and their leaves with words) are one and the same.
+      AssertThat(b.concrete_tree_size(), Is().EqualTo(12u));
+      AssertThat(fb.dag_size(), Is().EqualTo(7u));
+
+      AssertThat(fb.size(), Is().EqualTo(4u));
+      AssertThat(fb.contains("ax"), Is().True());
+      AssertThat(fb.contains("dx"), Is().True());
+      AssertThat(fb.contains("x"), Is().False());
+      AssertThat(fb.anagrams_of("xc") == b.anagrams_of("xc"), Is().True());
+      AssertThat(fb.subanagrams_of("abdxx") == b.subanagrams_of("abdxx"), Is().True());
+    });
+
+    it("is unaffected by changes to the original", [&]() {
+      anatree<> b(a);
+      const frozen_anatree<> fb = b.freeze();
+      b.insert("good");
+
+      AssertThat(fb.contains("good"), Is().False());
+      AssertThat(fb.size(), Is().EqualTo(a.size()));
+    });
+
+    const std::string path =
+      (std::filesystem::temp_directory_path() / "anatree_test.bin").string();
+
+    it("can save(path) and load(path) again", [&]() {
+      f.save(path);
+      const frozen_anatree<> l = frozen_anatree<>::load(path);
+
+      AssertThat(l.size(), Is().EqualTo(f.size()));
+      AssertThat(l.tree_size(), Is().EqualTo(f.tree_size()));
+      AssertThat(l.memory_size(), Is().EqualTo(f.memory_size()));
+
+      AssertThat(l.contains("gold"), Is().True());
+      AssertThat(l.contains("good"), Is().False());
+      AssertThat(l.subanagrams_of("goldfood") == f.subanagrams_of("goldfood"), Is().True());
+    });
+
+    it("can save(path) and load_mmap(path) again", [&]() {
+      f.save(path);
+      const frozen_anatree<> l = frozen_anatree<>::load_mmap(path);
+
+      AssertThat(l.size(), Is().EqualTo(f.size()));
+      AssertThat(l.tree_size(), Is().EqualTo(f.tree_size()));
+
+      AssertThat(l.contains("oo"), Is().True());
+      AssertThat(l.has_anagram_of("odg"), Is().True());
+      AssertThat(l.anagrams_of("dog") == f.anagrams_of("dog"), Is().True());
+      AssertThat(l.subanagrams_of("goldfood") == f.subanagrams_of("goldfood"), Is().True());
+    });
+
+    it("can save(path) and load_mmap(path) Ø", [&]() {
+      frozen_anatree<>().save(path);
+      const frozen_anatree<> l = frozen_anatree<>::load_mmap(path);
+
+      AssertThat(l.empty(), Is().True());
+      AssertThat(l.contains(""), Is().False());
+    });
+
+    it("saves the same tree as the same bytes", [&]() {
+      const auto read_file = [](const std::string &p) {
+        std::ifstream in(p, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+      };
+
+      const std::string path_w =
+        (std::filesystem::temp_directory_path() / "anatree_test_w.bin").string();
+
+      // Leave non-zero bytes on the heap between the two trees.
+      a.freeze().save(path);
+      const std::string bytes = read_file(path);
+      { std::vector<char> junk(1u << 16u, char(0xa5)); }
+      a.freeze().save(path);
+      AssertThat(read_file(path) == bytes, Is().True());
+
+      // 'wchar_t' nodes have a padding byte after 'm_run'.
+      const std::vector<std::wstring> wws = { L"", L"a", L"do", L"dog", L"god", L"gold" };
+      const anatree<std::wstring> aw(wws.begin(), wws.end());
+      aw.freeze().save(path_w);
+      const std::string bytes_w = read_file(path_w);
+      { std::vector<char> junk(1u << 16u, char(0x5a)); }
+      aw.freeze().save(path_w);
+      AssertThat(read_file(path_w) == bytes_w, Is().True());
+
+      std::filesystem::remove(path_w);
+    });
+
+    it("rejects loading a file of another format", [&]() {
+      {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << "This is not an Anatree, but it is long enough to have a header.";
+      }
+
+      bool thrown = false;
+      try { frozen_anatree<>::load_mmap(path); }
+      catch (const std::runtime_error &) { thrown = true; }
+      AssertThat(thrown, Is().True());
+    });
+
+    it("rejects loading a file with a corrupted body", [&]() {
+      f.save(path);
+
+      std::string bytes;
+      {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+      }
+      AssertThat(200u < bytes.size(), Is().True());
+
+      // Overwrite the first nodes (behind the 64-byte header).
+      for (size_t i = 80u; i < 200u; ++i) { bytes[i] = char(0xff); }
+      {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << bytes;
+      }
+
+      bool thrown = false;
+      try { frozen_anatree<>::load(path).subanagrams_of("abcdgot"); }
+      catch (const std::runtime_error &) { thrown = true; }
+      AssertThat(thrown, Is().True());
+
+      thrown = false;
+      try { frozen_anatree<>::load_mmap(path).subanagrams_of("abcdgot"); }
+      catch (const std::runtime_error &) { thrown = true; }
+      AssertThat(thrown, Is().True());
+    });
+
+    it("rejects loading a file with another character type", [&]() {
+      f.save(path);
+
+      bool thrown = false;
+      try { frozen_anatree<std::wstring>::load(path); }
+      catch (const std::runtime_error &) { thrown = true; }
+      AssertThat(thrown, Is().True());
+    });
+  });
+
+  describe("concurrent_anatree<std::string, std::less>", []() {
+    it("is initially empty", []() {
+      concurrent_anatree<> a;
+      AssertThat(a.empty(), Is().True());
+      AssertThat(a.size(), Is().EqualTo(0u));
+      AssertThat(a.contains("a"), Is().False());
+    });
+
+    it("can be constructed from an anatree", []() {
+      anatree<> a;
+      a.insert("dog");
+      a.insert("god");
+
+      concurrent_anatree<> ca(std::move(a));
+      AssertThat(ca.size(), Is().EqualTo(2u));
+      AssertThat(ca.contains("dog"), Is().True());
+    });
+
+    it("can insert words and answer queries", []() {
+      concurrent_anatree<> a;
+      a.insert("do");
+      a.insert("dog");
+
+      const std::vector<std::string> ws = { "god", "gold" };
+      a.insert(ws.begin(), ws.end());
+
+      AssertThat(a.size(), Is().EqualTo(4u));
+      AssertThat(a.contains("gold"), Is().True());
+      AssertThat(a.has_anagram_of("ogd"), Is().True());
+
+      const std::unordered_set<std::string> anagrams = { "dog", "god" };
+      AssertThat(a.anagrams_of("odg") == anagrams, Is().True());
+
+      const std::unordered_set<std::string> subanagrams = { "do", "dog", "god" };
+      AssertThat(a.subanagrams_of("dogs") == subanagrams, Is().True());
+    });
+
+    it("can erase words", []() {
+      concurrent_anatree<> a;
+      a.insert("dog");
+      a.insert("god");
+      a.erase("dog");
+
+      AssertThat(a.size(), Is().EqualTo(1u));
+      AssertThat(a.contains("dog"), Is().False());
+      AssertThat(a.contains("god"), Is().True());
+    });
+
+    it("applies an update as a single new version", []() {
+      concurrent_anatree<> a;
+      a.update([](anatree<> &t) {
+        t.insert("a");
+        t.insert("b");
+      });
+      AssertThat(a.size(), Is().EqualTo(2u));
+    });
+
+    it("leaves earlier snapshots unchanged", []() {
+      concurrent_anatree<> a;
+      a.insert("a");
+
+      const auto s = a.snapshot();
+      a.insert("b");
+      a.clear();
+
+      AssertThat(s->size(), Is().EqualTo(1u));
+      AssertThat(s->contains("a"), Is().True());
+      AssertThat(s->contains("b"), Is().False());
+
+      AssertThat(a.empty(), Is().True());
+    });
+
+    it("can be read while it is being updated", []() {
+      concurrent_anatree<> a;
+      a.insert("ab");
+
+      std::atomic<bool> done = false;
+      std::thread writer([&]() {
+        for (char c = 'c'; c <= 'z'; ++c) { a.insert(std::string{ 'a', c }); }
+        done = true;
+      });
+
+      size_t last_size = 1u;
+      bool monotone = true;
+      while (!done) {
+        const auto s = a.snapshot();
+        monotone &= last_size <= s->size() && s->contains("ab");
+        last_size = s->size();
+      }
+      writer.join();
+
+      AssertThat(monotone, Is().True());
+      AssertThat(a.size(), Is().EqualTo(25u));
+      AssertThat(a.subanagrams_of("abcz").size(), Is().EqualTo(3u));
+    });
+  });
+
+  describe("sharded_anatree<std::string, std::less>", []() {
+    const std::vector<std::string> ws = { "", "a", "do", "dog", "god", "gold", "good", "og", "zoo" };
+
+    it("rejects zero shards", []() {
+      bool thrown = false;
+      try { sharded_anatree<> a(0u); }
+      catch (const std::invalid_argument &) { thrown = true; }
+      AssertThat(thrown, Is().True());
+    });
+
+    it("places all anagrams in the same shard", [&]() {
+      for (const auto part : { sharded_anatree<>::partition::first_char,
+                               sharded_anatree<>::partition::key_hash }) {
+        const sharded_anatree<> a(4u, ws.begin(), ws.end(), part);
+
+        AssertThat(a.shards(), Is().EqualTo(4u));
+        AssertThat(a.size(), Is().EqualTo(ws.size()));
+        AssertThat(a.shard_of("dog"), Is().EqualTo(a.shard_of("god")));
+        AssertThat(a.shard(a.shard_of("dog")).anagrams_of("odg").size(), Is().EqualTo(2u));
+        AssertThat(a.shard_of(""), Is().EqualTo(0u));
+      }
+    });
+
+    it("places words by the FNV-1a hash of the first character of their key", [&]() {
+      const sharded_anatree<> a(256u, ws.begin(), ws.end());
+
+      // FNV-1a("o") = 0xaf63e24c8601f6be, FNV-1a("d") = 0xaf63d94c8601e773,
+      // and FNV-1a("z") = 0xaf63f74c86021a6d.
+      AssertThat(a.shard_of("zoo"), Is().EqualTo(0xbeu));
+      AssertThat(a.shard_of("gold"), Is().EqualTo(0x73u));
+      AssertThat(a.shard(0x73u).size(), Is().EqualTo(5u));
+      AssertThat(a.shards_of_subanagrams("zoo") == std::vector<size_t>({ 0u, 0x6du, 0xbeu }),
+                 Is().True());
+    });
+
+    it("places words by the FNV-1a hash of their entire key", [&]() {
+      const sharded_anatree<> a(256u, ws.begin(), ws.end(), sharded_anatree<>::partition::key_hash);
+
+      // FNV-1a("dgo") = 0xca934318f45c0bc9 and FNV-1a("dglo") = 0x943cc967385faced.
+      AssertThat(a.shard_of("dog"), Is().EqualTo(0xc9u));
+      AssertThat(a.shard_of("gold"), Is().EqualTo(0xedu));
+      AssertThat(a.shard(0xc9u).size(), Is().EqualTo(2u));
+    });
+
+    it("can insert words and answer queries", [&]() {
+      for (const auto part : { sharded_anatree<>::partition::first_char,
+                               sharded_anatree<>::partition::key_hash }) {
+        sharded_anatree<> a(3u, part);
+        a.insert("dog");
+        a.insert(ws.begin(), ws.end());
+        a.insert("dogs");
+
+        const anatree<> b(ws.begin(), ws.end());
+
+        AssertThat(a.size(), Is().EqualTo(b.size() + 1u));
+        AssertThat(a.contains("gold"), Is().True());
+        AssertThat(a.contains("dg"), Is().False());
+        AssertThat(a.has_anagram_of("ogd"), Is().True());
+        AssertThat(a.has_anagram_of("ogz"), Is().False());
+        AssertThat(a.anagrams_of("odg") == b.anagrams_of("odg"), Is().True());
+
+        AssertThat(a.subanagrams_of("goldoz") == b.subanagrams_of("goldoz"), Is().True());
+        AssertThat(a.count_subanagrams_of("goldoz"), Is().EqualTo(b.count_subanagrams_of("goldoz")));
+        AssertThat(a.subanagrams_of("dogs").size(), Is().EqualTo(b.subanagrams_of("dogs").size() + 1u));
+      }
+    });
+
+    it("can search shards in parallel", []() {
+      std::vector<std::string> words;
+      for (char x = 'a'; x <= 'z'; ++x) {
+        for (char y = 'a'; y <= 'z'; ++y) {
+          for (char z = 'a'; z <= 'e'; ++z) { words.push_back({ x, y, z }); }
+        }
+      }
+      const sharded_anatree<> a(8u, words.begin(), words.end());
+      const anatree<> b(words.begin(), words.end());
+
+      AssertThat(a.size(), Is().EqualTo(words.size()));
+      AssertThat(a.subanagrams_of("abcdefghijklmnopqrstuvwxyz") == b.subanagrams_of("abcdefghijklmnopqrstuvwxyz"),
+                 Is().True());
+    });
+
+    it("can search shards with a set of words without merge(...)", [&]() {
+      struct set_type : std::unordered_set<std::string>
+      {
+        using std::unordered_set<std::string>::unordered_set;
+        void merge(std::unordered_set<std::string>&) = delete;
+      };
+      const sharded_anatree<std::string, std::less<char>, set_type> a(3u, ws.begin(), ws.end());
+      const anatree<> b(ws.begin(), ws.end());
+
+      AssertThat(a.subanagrams_of("goldoz").size(), Is().EqualTo(b.subanagrams_of("goldoz").size()));
+    });
+
+    it("can erase words and be cleared", [&]() {
+      sharded_anatree<> a(4u, ws.begin(), ws.end());
+      AssertThat(a.erase("dog"), Is().EqualTo(1u));
+      AssertThat(a.erase("dog"), Is().EqualTo(0u));
+
+      AssertThat(a.contains("dog"), Is().False());
+      AssertThat(a.contains("god"), Is().True());
+
+      a.clear();
+      AssertThat(a.empty(), Is().True());
+      AssertThat(a.contains("god"), Is().False());
+    });
+
+    it("can save each shard and load it again", [&]() {
+      const sharded_anatree<> a(3u, ws.begin(), ws.end());
+      const std::string path =
+        (std::filesystem::temp_directory_path() / "anatree_shard_test.bin").string();
+
+      size_t size = 0u;
+      for (size_t i = 0u; i < a.shards(); ++i) {
+        a.save(i, path);
+        const frozen_anatree<> l = frozen_anatree<>::load(path);
+        size += l.size();
+
+        AssertThat(l.subanagrams_of("goldoz") == a.shard(i).subanagrams_of("goldoz"), Is().True());
+      }
+      AssertThat(size, Is().EqualTo(a.size()));
+    });
+  });
+
+  describe("query_cache<std::string, std::less>", []() {
+    const std::vector<std::string> ws = { "", "a", "do", "dog", "god", "gold", "good", "og", "zoo" };
+
+    it("changes the epoch of an anatree with its words", [&]() {
+      anatree<> a;
+      AssertThat(a.epoch(), Is().EqualTo(0u));
+
+      a.insert("dog");
+      const uint64_t e = a.epoch();
+      AssertThat(e == 0u, Is().False());
+
+      a.insert("dog");
+      AssertThat(a.epoch(), Is().EqualTo(e));
+
+      const anatree<> b(a);
+      AssertThat(b.epoch(), Is().EqualTo(e));
+
+      a.erase("dog");
+      AssertThat(a.epoch() == e, Is().False());
+      AssertThat(b.epoch(), Is().EqualTo(e));
+    });
+
+    it("rejects zero stripes", []() {
+      bool thrown = false;
+      try { query_cache<> c(16u, 0u); }
+      catch (const std::invalid_argument &) { thrown = true; }
+      AssertThat(thrown, Is().True());
+    });
+
+    it("shares the result of queries with the same key", [&]() {
+      const anatree<> a(ws.begin(), ws.end());
+      query_cache<> c(16u);
+
+      const auto r = c.subanagrams_of(a, "dogl");
+      AssertThat(*r == a.subanagrams_of("dogl"), Is().True());
+      AssertThat(c.size(), Is().EqualTo(1u));
+
+      AssertThat(c.subanagrams_of(a, "gold") == r, Is().True());
+      AssertThat(c.subanagrams_of(a, std::string_view("lgod")) == r, Is().True());
+      AssertThat(c.size(), Is().EqualTo(1u));
+    });
+
+    it("recomputes results after the anatree is changed", [&]() {
+      anatree<> a(ws.begin(), ws.end());
+      query_cache<> c(16u);
+
+      const auto r = c.subanagrams_of(a, "dogo");
+      a.insert("goo");
+
+      const auto s = c.subanagrams_of(a, "dogo");
+      AssertThat(s == r, Is().False());
+      AssertThat(s->size(), Is().EqualTo(r->size() + 1u));
+      AssertThat(*s == a.subanagrams_of("dogo"), Is().True());
+      AssertThat(c.size(), Is().EqualTo(1u));
+    });
+
+    it("keeps at most capacity() results", [&]() {
+      const anatree<> a(ws.begin(), ws.end());
+      query_cache<> c(4u, 2u);
+      AssertThat(c.capacity(), Is().EqualTo(4u));
+
+      for (const std::string w : { "a", "do", "dog", "zoo", "gold", "good", "og", "dogz" }) {
+        AssertThat(*c.subanagrams_of(a, w) == a.subanagrams_of(w), Is().True());
+        AssertThat(c.size() <= c.capacity(), Is().True());
+      }
+
+      c.clear();
+      AssertThat(c.size(), Is().EqualTo(0u));
+    });
+
+    it("caches nothing with a capacity of 0", [&]() {
+      const anatree<> a(ws.begin(), ws.end());
+      query_cache<> c(0u);
+
+      AssertThat(*c.subanagrams_of(a, "dog") == a.subanagrams_of("dog"), Is().True());
+      AssertThat(c.size(), Is().EqualTo(0u));
+    });
+
+    it("counts hits and misses", [&]() {
+      const anatree<> a(ws.begin(), ws.end());
+      query_cache<> c(16u);
+
+      anatree<>::reset_query_stats();
+      c.subanagrams_of(a, "dog");
+      c.subanagrams_of(a, "god");
+      c.subanagrams_of(a, "zoo");
+
+      const traversal_stats s = anatree<>::query_stats();
+      AssertThat(s.cache_hits,   Is().EqualTo(anatree<>::has_query_stats ? 1u : 0u));
+      AssertThat(s.cache_misses, Is().EqualTo(anatree<>::has_query_stats ? 2u : 0u));
+    });
+
+    it("can be used by several threads at once", [&]() {
+      const anatree<> a(ws.begin(), ws.end());
+      query_cache<> c(4u, 2u);
+
+      std::atomic<bool> correct = true;
+      std::vector<std::thread> readers;
+      for (size_t t = 0u; t < 4u; ++t) {
+        readers.emplace_back([&, t]() {
+          const std::string qs[] = { "dog", "gold", "zoo", "goodz", "ad", "oo" };
+          for (size_t i = 0u; i < 200u; ++i) {
+            const std::string &q = qs[(i + t) % 6u];
+            correct = correct && *c.subanagrams_of(a, q) == a.subanagrams_of(q);
+          }
+        });
+      }
+      for (auto &r : readers) { r.join(); }
+
+      AssertThat(correct.load(), Is().True());
+    });
+  });
  });
 
 // -------------------------------------------------------------------------- //